@@ -40,6 +40,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 
 static bool is_modified = false;
+/* rows changed since last matrix_changed_rows() */
+static matrix_rows_t matrix_changed = 0;
 static report_mouse_t mouse_report = {};
 
 // matrix state buffer(1:on, 0:off)
@@ -227,6 +229,13 @@ uint16_t matrix_get_row(uint8_t row)
     return matrix[row];
 }
 
+matrix_rows_t matrix_changed_rows(void)
+{
+    matrix_rows_t changed = matrix_changed;
+    matrix_changed = 0;
+    return changed;
+}
+
 void matrix_print(void)
 {
     if (!debug_matrix) return;
@@ -292,5 +301,6 @@ static void register_key(uint8_t key)
     } else {
         matrix[row] |=  (1<<col);
     }
+    matrix_changed |= ((matrix_rows_t)1<<row);
     is_modified = true;
 }
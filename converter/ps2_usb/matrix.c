@@ -67,6 +67,8 @@ static uint8_t matrix[MATRIX_ROWS];
 #define PAUSE          (0xFE)
 
 static bool is_modified = false;
+/* rows changed since last matrix_changed_rows() */
+static matrix_rows_t matrix_changed = 0;
 
 
 inline
@@ -419,6 +421,13 @@ uint8_t matrix_get_row(uint8_t row)
     return matrix[row];
 }
 
+matrix_rows_t matrix_changed_rows(void)
+{
+    matrix_rows_t changed = matrix_changed;
+    matrix_changed = 0;
+    return changed;
+}
+
 void matrix_print(void)
 {
     print("\nr/c 01234567\n");
@@ -466,6 +475,7 @@ static void matrix_make(uint8_t code)
 {
     if (!matrix_is_on(ROW(code), COL(code))) {
         matrix[ROW(code)] |= 1<<COL(code);
+        matrix_changed |= ((matrix_rows_t)1<<ROW(code));
         is_modified = true;
     }
 }
@@ -475,6 +485,7 @@ static void matrix_break(uint8_t code)
 {
     if (matrix_is_on(ROW(code), COL(code))) {
         matrix[ROW(code)] &= ~(1<<COL(code));
+        matrix_changed |= ((matrix_rows_t)1<<ROW(code));
         is_modified = true;
     }
 }
@@ -483,4 +494,5 @@ inline
 static void matrix_clear(void)
 {
     for (uint8_t i=0; i < MATRIX_ROWS; i++) matrix[i] = 0x00;
+    matrix_changed = ~(matrix_rows_t)0;
 }
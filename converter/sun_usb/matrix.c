@@ -47,6 +47,8 @@ static uint8_t matrix[MATRIX_ROWS];
 #define COL(code)      (code&0x07)
 
 static bool is_modified = false;
+/* rows changed since last matrix_changed_rows() */
+static matrix_rows_t matrix_changed = 0;
 
 
 inline
@@ -124,6 +126,7 @@ uint8_t matrix_scan(void)
         case 0x7F:
             // all keys up
             for (uint8_t i=0; i < MATRIX_ROWS; i++) matrix[i] = 0x00;
+            matrix_changed = ~(matrix_rows_t)0;
             return 0;
     }
 
@@ -131,12 +134,14 @@ uint8_t matrix_scan(void)
         // break code
         if (matrix_is_on(ROW(code), COL(code))) {
             matrix[ROW(code)] &= ~(1<<COL(code));
+            matrix_changed |= ((matrix_rows_t)1<<ROW(code));
             is_modified = true;
         }
     } else {
         // make code
         if (!matrix_is_on(ROW(code), COL(code))) {
             matrix[ROW(code)] |=  (1<<COL(code));
+            matrix_changed |= ((matrix_rows_t)1<<ROW(code));
             is_modified = true;
         }
     }
@@ -166,6 +171,13 @@ uint8_t matrix_get_row(uint8_t row)
     return matrix[row];
 }
 
+matrix_rows_t matrix_changed_rows(void)
+{
+    matrix_rows_t changed = matrix_changed;
+    matrix_changed = 0;
+    return changed;
+}
+
 void matrix_print(void)
 {
     print("\nr/c 01234567\n");
@@ -17,6 +17,7 @@
 #include "sendchar.h"
 #include "debug.h"
 #include "keyboard.h"
+#include "profile.h"
 
 
 /* LED ping configuration */
@@ -116,7 +117,9 @@ uint16_t timer;
         keyboard_task();
 
 timer = timer_read();
+        PROFILE_BEGIN(PROFILE_HOST_TASK);
         usb_host.Task();
+        PROFILE_END(PROFILE_HOST_TASK);
 timer = timer_elapsed(timer);
 if (timer > 100) {
     debug("host.Task: "); debug_hex16(timer);  debug("\n");
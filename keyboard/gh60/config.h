@@ -31,9 +31,15 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define MATRIX_ROWS 5
 #define MATRIX_COLS 14
 
+/* column pins(Rev.A), Rev.B has col 8 on B7 too */
+#define MATRIX_COL_PINS { F0, F1, E6, C7, C6, B6, D4, B1, B0, B5, B4, D7, D6, B3 }
+
 /* define if matrix has ghost */
 //#define MATRIX_HAS_GHOST
 
+/* settle time of row is calibrated at startup instead of fixed 30us */
+//#define MATRIX_SCAN_PIPELINE
+
 /* Set 0 if debouncing isn't needed */
 #define DEBOUNCE    5
 
@@ -25,20 +25,37 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "print.h"
 #include "debug.h"
 #include "util.h"
+#include "timer.h"
 #include "matrix.h"
+#include "debounce.h"
+#include "avr/pin_map.h"
 
 
-#ifndef DEBOUNCE
-#   define DEBOUNCE	5
-#endif
-static uint8_t debouncing = DEBOUNCE;
-
 /* matrix state(1:on, 0:off) */
 static matrix_row_t matrix[MATRIX_ROWS];
 static matrix_row_t matrix_debouncing[MATRIX_ROWS];
+/* rows changed since last matrix_changed_rows() */
+static matrix_rows_t matrix_changed = 0;
+/* time when row state changed last(lower 16bit of timer_read_us) */
+static uint16_t matrix_debouncing_time[MATRIX_ROWS];
+#ifdef MATRIX_SCAN_PIPELINE
+/* upper limit of settle time in column reads, about 30us */
+#ifndef MATRIX_SETTLE_READS_MAX
+#   define MATRIX_SETTLE_READS_MAX  16
+#endif
+/* added to calibrated value for load of pressed keys, temperature and supply drift */
+#ifndef MATRIX_SETTLE_READS_FLOOR
+#   define MATRIX_SETTLE_READS_FLOOR    4
+#endif
+static uint8_t settle_reads = MATRIX_SETTLE_READS_MAX;
+#endif
 
 static matrix_row_t read_cols(void);
 static void init_cols(void);
+#ifdef MATRIX_SCAN_PIPELINE
+static void discharge_cols(void);
+static void calibrate_settle(void);
+#endif
 static void unselect_rows(void);
 static void select_row(uint8_t row);
 
@@ -66,40 +83,60 @@ void matrix_init(void)
         matrix[i] = 0;
         matrix_debouncing[i] = 0;
     }
+    debounce_init();
+#ifdef MATRIX_SCAN_PIPELINE
+    calibrate_settle();
+#endif
 }
 
+/* wait for selected row to settle */
+static inline void settle_row(void)
+{
+#ifdef MATRIX_SCAN_PIPELINE
+    // bookkeeping of previous row has already taken part of settle time
+    for (uint8_t n = settle_reads; n; n--) {
+        read_cols();
+    }
+#else
+    _delay_us(30);  // without this wait read unstable value.
+#endif
+}
+
+/*
+ * Next row is selected right after columns of current row are read, and
+ * bookkeeping and debounce of current row are done while the next row
+ * settles.
+ */
 uint8_t matrix_scan(void)
 {
+    uint16_t now = timer_read_us();
+    debounce_begin();
+    select_row(0);
     for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
-        select_row(i);
-        _delay_us(30);  // without this wait read unstable value.
+        settle_row();
         matrix_row_t cols = read_cols();
+        unselect_rows();
+        if (i + 1 < MATRIX_ROWS) select_row(i + 1);
+
         if (matrix_debouncing[i] != cols) {
             matrix_debouncing[i] = cols;
-            if (debouncing) {
-                debug("bounce!: "); debug_hex(debouncing); debug("\n");
-            }
-            debouncing = DEBOUNCE;
+            matrix_debouncing_time[i] = timer_read_us();
+        } else if ((uint16_t)(now - matrix_debouncing_time[i]) > MATRIX_ROW_TIME_AGE_MAX) {
+            // debounce may hold the change longer than the time can tell
+            matrix_debouncing_time[i] = now - MATRIX_ROW_TIME_AGE_MAX;
         }
-        unselect_rows();
-    }
-
-    if (debouncing) {
-        if (--debouncing) {
-            _delay_ms(1);
-        } else {
-            for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
-                matrix[i] = matrix_debouncing[i];
-            }
+        if (debounce_row(i, cols, &matrix[i])) {
+            matrix_changed |= ((matrix_rows_t)1<<i);
         }
     }
+    matrix_changed |= debounce_end(matrix);
 
     return 1;
 }
 
 bool matrix_is_modified(void)
 {
-    if (debouncing) return false;
+    if (debounce_active()) return false;
     return true;
 }
 
@@ -115,6 +152,20 @@ matrix_row_t matrix_get_row(uint8_t row)
     return matrix[row];
 }
 
+matrix_rows_t matrix_changed_rows(void)
+{
+    matrix_rows_t changed = matrix_changed;
+    matrix_changed = 0;
+    return changed;
+}
+
+inline
+uint16_t matrix_get_row_time(uint8_t row)
+{
+    // row is committed on the scan its last change settles
+    return matrix_debouncing_time[row];
+}
+
 void matrix_print(void)
 {
     print("\nr/c 0123456789ABCDEF\n");
@@ -139,37 +190,53 @@ uint8_t matrix_key_count(void)
  * pin: F0  F1  E6  C7  C6  B6  D4  B1  B0  B5  B4  D7  D6  B3  (Rev.A)
  * pin:                                 B7                      (Rev.B)
  */
+static const uint8_t col_pins[MATRIX_COLS] = MATRIX_COL_PINS;
+
 static void  init_cols(void)
 {
-    // Input with pull-up(DDR:0, PORT:1)
-    DDRF  &= ~(1<<0 | 1<<1);
-    PORTF |=  (1<<0 | 1<<1);
-    DDRE  &= ~(1<<6);
-    PORTE |=  (1<<6);
-    DDRD  &= ~(1<<7 | 1<<6 | 1<<4);
-    PORTD |=  (1<<7 | 1<<6 | 1<<4);
-    DDRC  &= ~(1<<7 | 1<<6);
-    PORTC |=  (1<<7 | 1<<6);
-    DDRB  &= ~(1<<7 | 1<<6 | 1<< 5 | 1<<4 | 1<<3 | 1<<1 | 1<<0);
-    PORTB |=  (1<<7 | 1<<6 | 1<< 5 | 1<<4 | 1<<3 | 1<<1 | 1<<0);
+    pins_input_pullup(col_pins, MATRIX_COLS);
+    // Rev.B
+    DDRB  &= ~(1<<7);
+    PORTB |=  (1<<7);
+}
+
+#ifdef MATRIX_SCAN_PIPELINE
+/* Output low(DDR:1, PORT:0) to discharge column lines */
+static void discharge_cols(void)
+{
+    pins_output_low(col_pins, MATRIX_COLS);
+    PORTB &= ~(1<<7);
+    DDRB  |=  (1<<7);
 }
 
+/*
+ * Measure how many column reads it takes for the pull-ups to recover the
+ * discharged column lines, which is the case after a row with pressed key
+ * is unselected. Rows are unselected so that keys don't affect this.
+ */
+static void calibrate_settle(void)
+{
+    uint8_t worst = 0;
+    for (uint8_t i = 0; i < 8; i++) {
+        discharge_cols();
+        _delay_us(1);
+        init_cols();
+        uint8_t n = 1;
+        while (read_cols() && n < MATRIX_SETTLE_READS_MAX) n++;
+        if (n > worst) worst = n;
+    }
+    // double and add floor for margin
+    uint8_t reads = worst * 2 + MATRIX_SETTLE_READS_FLOOR;
+    settle_reads = (reads < MATRIX_SETTLE_READS_MAX ? reads : MATRIX_SETTLE_READS_MAX);
+    dprintf("settle reads: %u\n", settle_reads);
+}
+#endif
+
 static matrix_row_t read_cols(void)
 {
-    return (PINF&(1<<0) ? 0 : (1<<0)) |
-           (PINF&(1<<1) ? 0 : (1<<1)) |
-           (PINE&(1<<6) ? 0 : (1<<2)) |
-           (PINC&(1<<7) ? 0 : (1<<3)) |
-           (PINC&(1<<6) ? 0 : (1<<4)) |
-           (PINB&(1<<6) ? 0 : (1<<5)) |
-           (PIND&(1<<4) ? 0 : (1<<6)) |
-           (PINB&(1<<1) ? 0 : (1<<7)) |
-           ((PINB&(1<<0) && PINB&(1<<7)) ? 0 : (1<<8)) |     // Rev.A and B
-           (PINB&(1<<5) ? 0 : (1<<9)) |
-           (PINB&(1<<4) ? 0 : (1<<10)) |
-           (PIND&(1<<7) ? 0 : (1<<11)) |
-           (PIND&(1<<6) ? 0 : (1<<12)) |
-           (PINB&(1<<3) ? 0 : (1<<13));
+    // one read for each port, col 8 is also on B7 with Rev.B
+    return PINS_READ_LOW(col_pins) |
+           (PINB&(1<<7) ? 0 : (1<<8));
 }
 
 /* Row pin configuration
@@ -21,6 +21,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <stdint.h>
 #include <stdbool.h>
 #include <util/delay.h>
+#include <avr/interrupt.h>
 #include "print.h"
 #include "debug.h"
 #include "util.h"
@@ -41,6 +42,46 @@ static matrix_row_t *matrix;
 static matrix_row_t *matrix_prev;
 static matrix_row_t _matrix0[MATRIX_ROWS];
 static matrix_row_t _matrix1[MATRIX_ROWS];
+// time when row was sampled(lower 16bit of timer_read_us)
+static uint16_t matrix_time[MATRIX_ROWS];
+
+#ifdef HHKB_SCAN_TIMER
+#ifdef MATRIX_SCAN_ISR
+#   error "HHKB_SCAN_TIMER and MATRIX_SCAN_ISR both use Timer3"
+#endif
+#ifndef TCNT3
+#   error "HHKB_SCAN_TIMER needs Timer3 which this MCU doesn't have"
+#endif
+/*
+ * Scan timing by hardware timer
+ *
+ * Timer3 runs free at F_CPU/8 and waits are done until a point of the
+ * timer instead of delay loops, so that interrupts during wait don't
+ * stretch the scan. KEY_STATE read is done with interrupts disabled for
+ * the 5us after KEY_ENABLE and never misses the 20us window. Selecting
+ * next key overlaps recovery time of previous key, also of last key of
+ * previous scan.
+ */
+#define SCAN_TIMER_FREQ     (F_CPU/8)
+#define US_TICKS(us)        ((uint16_t)(((uint32_t)(us) * (SCAN_TIMER_FREQ/1000) + 999) / 1000))
+
+/* time(us) for KEY_STATE to return to idle after KEY_UNABLE */
+#ifndef HHKB_KEY_RECOVERY
+#   ifdef HHKB_JP
+#       define HHKB_KEY_RECOVERY    30
+#   else
+#       define HHKB_KEY_RECOVERY    75
+#   endif
+#endif
+
+static inline void wait_until(uint16_t t)
+{
+    while ((int16_t)(TCNT3 - t) < 0) ;
+}
+
+// time when next key can be enabled
+static uint16_t ready;
+#endif
 
 
 inline
@@ -63,6 +104,11 @@ void matrix_init(void)
 #endif
 
     KEY_INIT();
+#ifdef HHKB_SCAN_TIMER
+    // normal mode, prescaler 8
+    TCCR3A = 0;
+    TCCR3B = (1<<CS31);
+#endif
 
     // initialize matrix state: all keys off
     for (uint8_t i=0; i < MATRIX_ROWS; i++) _matrix0[i] = 0x00;
@@ -81,7 +127,57 @@ uint8_t matrix_scan(void)
 
     // power on
     if (!KEY_POWER_STATE()) KEY_POWER_ON();
+#ifdef HHKB_SCAN_TIMER
+    // recovery of last key from previous scan may be still running, older
+    // time than that is stale after timer wraparound
+    if ((uint16_t)(ready - TCNT3) > US_TICKS(HHKB_KEY_RECOVERY)) {
+        ready = TCNT3;
+    }
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        uint16_t row_time = timer_read_us();
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            KEY_SELECT(row, col);
+            uint16_t selected = TCNT3;
+
+            // Not sure this is needed. This just emulates HHKB controller's behaviour.
+            if (matrix_prev[row] & (1<<col)) {
+                KEY_PREV_ON();
+            }
+
+            // 15us from select to enable, overlapped with recovery of previous key
+            if ((int16_t)(selected + US_TICKS(15) - ready) > 0) {
+                ready = selected + US_TICKS(15);
+            }
+            wait_until(ready);
+
+            uint8_t sreg = SREG;
+            cli();
+            KEY_ENABLE();
+            uint16_t enabled = TCNT3;
+            // Wait for KEY_STATE outputs its value, see below for 5us.
+            wait_until(enabled + US_TICKS(5));
+            bool state = KEY_STATE();
+            SREG = sreg;
+
+            if (state) {
+                matrix[row] &= ~(1<<col);
+            } else {
+                matrix[row] |= (1<<col);
+            }
+
+            wait_until(enabled + US_TICKS(10));
+            KEY_PREV_OFF();
+            KEY_UNABLE();
+            ready = TCNT3 + US_TICKS(HHKB_KEY_RECOVERY);
+        }
+        if (matrix[row] ^ matrix_prev[row]) {
+            matrix_last_modified = timer_read32();
+            matrix_time[row] = row_time;
+        }
+    }
+#else
     for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        uint16_t row_time = timer_read_us();
         for (uint8_t col = 0; col < MATRIX_COLS; col++) {
             KEY_SELECT(row, col);
             _delay_us(5);
@@ -140,8 +236,12 @@ uint8_t matrix_scan(void)
             _delay_us(75);
 #endif
         }
-        if (matrix[row] ^ matrix_prev[row]) matrix_last_modified = timer_read32();
+        if (matrix[row] ^ matrix_prev[row]) {
+            matrix_last_modified = timer_read32();
+            matrix_time[row] = row_time;
+        }
     }
+#endif
     // power off
     if (KEY_POWER_STATE() &&
             (USB_DeviceState == DEVICE_STATE_Suspended ||
@@ -180,6 +280,12 @@ matrix_row_t matrix_get_row(uint8_t row)
     return matrix[row];
 }
 
+inline
+uint16_t matrix_get_row_time(uint8_t row)
+{
+    return matrix_time[row];
+}
+
 void matrix_print(void)
 {
     print("\nr/c 01234567\n");
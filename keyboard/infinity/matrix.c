@@ -1,15 +1,13 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "gpio_api.h"
+#include "port_api.h"
 #include "timer.h"
 #include "wait.h"
 #include "matrix.h"
+#include "debounce.h"
 
 
-#ifndef DEBOUNCE
-#define DEBOUNCE    5
-#endif
-
 /*
  * Infinity Pinusage:
  * Column pins are input with internal pull-down. Row pins are output and strobe with high.
@@ -18,26 +16,22 @@
  *     col: { PTD1, PTD2, PTD3, PTD4, PTD5, PTD6, PTD7 }
  *     row: { PTB0, PTB1, PTB2, PTB3, PTB16, PTB17, PTC4, PTC5, PTD0 }
  */
-static gpio_t col[MATRIX_COLS];
+/* columns are read at once from PTD1-7 */
+static port_t col;
 static gpio_t row[MATRIX_ROWS];
 
 /* matrix state(1:on, 0:off) */
 static matrix_row_t matrix[MATRIX_ROWS];
 static matrix_row_t matrix_debouncing[MATRIX_ROWS];
-static bool debouncing = false;
-static uint16_t debouncing_time = 0;
+/* rows changed since last matrix_changed_rows() */
+static matrix_rows_t matrix_changed = 0;
 
 
 void matrix_init(void)
 {
     /* Column(sense) */
-    gpio_init_in_ex(&col[0], PTD1, PullDown);
-    gpio_init_in_ex(&col[1], PTD2, PullDown);
-    gpio_init_in_ex(&col[2], PTD3, PullDown);
-    gpio_init_in_ex(&col[3], PTD4, PullDown);
-    gpio_init_in_ex(&col[4], PTD5, PullDown);
-    gpio_init_in_ex(&col[5], PTD6, PullDown);
-    gpio_init_in_ex(&col[6], PTD7, PullDown);
+    port_init(&col, PortD, 0xFE, PIN_INPUT);
+    port_mode(&col, PullDown);
 
     /* Row(strobe) */
     gpio_init_out_ex(&row[0], PTB0, 0);
@@ -49,46 +43,23 @@ void matrix_init(void)
     gpio_init_out_ex(&row[6], PTC4, 0);
     gpio_init_out_ex(&row[7], PTC5, 0);
     gpio_init_out_ex(&row[8], PTD0, 0);
+
+    debounce_init();
 }
 
 uint8_t matrix_scan(void)
 {
     for (int i = 0; i < MATRIX_ROWS; i++) {
-        matrix_row_t r = 0;
-
         gpio_write(&row[i], 1);
         wait_us(1); // need wait to settle pin state
-        for (int j = 0; j < MATRIX_COLS; j++) {
-            if (gpio_read(&col[j])) {
-                r |= (1<<j);
-            }
-        }
+        matrix_row_t r = port_read(&col) >> 1;
         gpio_write(&row[i], 0);
 
-        if (matrix_debouncing[i] != r) {
-            matrix_debouncing[i] = r;
-            debouncing = true;
-            debouncing_time = timer_read();
-        }
+        matrix_debouncing[i] = r;
     }
 
-    if (debouncing && timer_elapsed(debouncing_time) > DEBOUNCE) {
-        for (int i = 0; i < MATRIX_ROWS; i++) {
-            matrix[i] = matrix_debouncing[i];
-        }
-        debouncing = false;
-    }
-/*
-    if (debouncing) {
-        if (--debouncing) {
-            return 0;
-        } else {
-            for (int i = 0; i < MATRIX_ROWS; i++) {
-                matrix[i] = matrix_debouncing[i];
-            }
-        }
-    }
-*/
+    matrix_changed |= debounce(matrix_debouncing, matrix);
+
     return 1;
 }
 
@@ -102,6 +73,13 @@ matrix_row_t matrix_get_row(uint8_t row)
     return matrix[row];
 }
 
+matrix_rows_t matrix_changed_rows(void)
+{
+    matrix_rows_t changed = matrix_changed;
+    matrix_changed = 0;
+    return changed;
+}
+
 void matrix_print(void)
 {
 }
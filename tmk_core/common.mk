@@ -7,12 +7,15 @@ SRC +=	$(COMMON_DIR)/host.c \
 	$(COMMON_DIR)/action_layer.c \
 	$(COMMON_DIR)/action_util.c \
 	$(COMMON_DIR)/keymap.c \
+	$(COMMON_DIR)/matrix_ghost.c \
+	$(COMMON_DIR)/debounce.c \
 	$(COMMON_DIR)/print.c \
 	$(COMMON_DIR)/debug.c \
 	$(COMMON_DIR)/util.c \
 	$(COMMON_DIR)/avr/suspend.c \
 	$(COMMON_DIR)/avr/xprintf.S \
 	$(COMMON_DIR)/avr/timer.c \
+	$(COMMON_DIR)/avr/matrix_isr.c \
 	$(COMMON_DIR)/avr/bootloader.c
 
 
@@ -64,6 +67,25 @@ ifdef BACKLIGHT_ENABLE
     OPT_DEFS += -DBACKLIGHT_ENABLE
 endif
 
+ifdef PROFILE_ENABLE
+    SRC += $(COMMON_DIR)/profile.c
+    OPT_DEFS += -DPROFILE_ENABLE
+endif
+
+ifdef GENERIC_MATRIX_ENABLE
+    SRC += $(COMMON_DIR)/avr/matrix.c
+endif
+
+ifdef TRACE_EEPROM_ENABLE
+    TRACE_ENABLE = yes
+    OPT_DEFS += -DTRACE_EEPROM
+endif
+
+ifdef TRACE_ENABLE
+    SRC += $(COMMON_DIR)/trace.c
+    OPT_DEFS += -DTRACE_ENABLE
+endif
+
 ifdef KEYMAP_SECTION_ENABLE
     OPT_DEFS += -DKEYMAP_SECTION_ENABLE
     EXTRALDFLAGS = -Wl,-L$(TMK_DIR),-Tldscript_keymap_avr5.x
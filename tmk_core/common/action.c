@@ -26,6 +26,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "action_macro.h"
 #include "action_util.h"
 #include "action.h"
+#include "matrix.h"
+#include "trace.h"
 
 #ifdef DEBUG_ACTION
 #include "debug.h"
@@ -39,6 +41,7 @@ void action_exec(keyevent_t event)
     if (!IS_NOEVENT(event)) {
         dprint("\n---- action_exec: start -----\n");
         dprint("EVENT: "); debug_event(event); dprintln();
+        trace_event(event);
     }
 
     keyrecord_t record = { .event = event };
@@ -62,7 +65,7 @@ void process_action(keyrecord_t *record)
 
     if (IS_NOEVENT(event)) { return; }
 
-    action_t action = layer_switch_get_action(event.key);
+    action_t action = layer_event_get_action(event);
     dprint("ACTION: "); debug_action(action);
 #ifndef NO_ACTION_LAYER
     dprint(" layer_state: "); layer_debug();
@@ -509,9 +512,45 @@ void clear_keyboard_but_mods(void)
 #endif
 }
 
+/*
+ * Whether key can be tap key is cached for each position while layer
+ * state stays same, so that most of events are checked without keymap
+ * lookup.
+ */
+#ifndef NO_ACTION_TAPPING
+static uint32_t tap_keys_layers = 0;
+static matrix_row_t tap_keys_known[MATRIX_ROWS];
+static matrix_row_t tap_keys[MATRIX_ROWS];
+#endif
+
+static bool action_is_tap(action_t action);
+
 bool is_tap_key(keypos_t key)
 {
-    action_t action = layer_switch_get_action(key);
+#ifndef NO_ACTION_TAPPING
+    uint32_t layers = layer_state | default_layer_state;
+    if (tap_keys_layers != layers) {
+        tap_keys_layers = layers;
+        for (uint8_t r = 0; r < MATRIX_ROWS; r++) tap_keys_known[r] = 0;
+    }
+
+    matrix_row_t bit = ((matrix_row_t)1<<key.col);
+    if (!(tap_keys_known[key.row] & bit)) {
+        if (action_is_tap(layer_switch_get_action(key))) {
+            tap_keys[key.row] |= bit;
+        } else {
+            tap_keys[key.row] &= ~bit;
+        }
+        tap_keys_known[key.row] |= bit;
+    }
+    return tap_keys[key.row] & bit;
+#else
+    return action_is_tap(layer_switch_get_action(key));
+#endif
+}
+
+static bool action_is_tap(action_t action)
+{
 
     switch (action.kind.id) {
         case ACT_LMODS_TAP:
@@ -2,6 +2,7 @@
 #include "keyboard.h"
 #include "action.h"
 #include "util.h"
+#include "matrix.h"
 #include "action_layer.h"
 
 #ifdef DEBUG_ACTION
@@ -22,7 +23,10 @@ static void default_layer_state_set(uint32_t state)
     default_layer_debug(); debug(" to ");
     default_layer_state = state;
     default_layer_debug(); debug("\n");
+    layer_action_cache_clear();
+#ifndef LAYER_ACTION_LATCH
     clear_keyboard_but_mods(); // To avoid stuck keys
+#endif
 }
 
 void default_layer_debug(void)
@@ -63,7 +67,10 @@ static void layer_state_set(uint32_t state)
     layer_debug(); dprint(" to ");
     layer_state = state;
     layer_debug(); dprintln();
+    layer_action_cache_clear();
+#ifndef LAYER_ACTION_LATCH
     clear_keyboard_but_mods(); // To avoid stuck keys
+#endif
 }
 
 void layer_clear(void)
@@ -112,7 +119,39 @@ void layer_debug(void)
 
 
 
+#ifdef LAYER_ACTION_CACHE
+/*
+ * Action Cache
+ *
+ * Action of key is resolved on first lookup and kept until layer state
+ * changes, later lookups are a table read.
+ */
+static action_t action_cache[MATRIX_ROWS][MATRIX_COLS];
+static matrix_row_t action_cached[MATRIX_ROWS];
+
+void layer_action_cache_clear(void)
+{
+    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+        action_cached[r] = 0;
+    }
+}
+
+static action_t layer_resolve_action(keypos_t key);
+
 action_t layer_switch_get_action(keypos_t key)
+{
+    matrix_row_t bit = ((matrix_row_t)1<<key.col);
+    if (!(action_cached[key.row] & bit)) {
+        action_cache[key.row][key.col] = layer_resolve_action(key);
+        action_cached[key.row] |= bit;
+    }
+    return action_cache[key.row][key.col];
+}
+
+static action_t layer_resolve_action(keypos_t key)
+#else
+action_t layer_switch_get_action(keypos_t key)
+#endif
 {
     action_t action;
     action.code = ACTION_TRANSPARENT;
@@ -136,3 +175,22 @@ action_t layer_switch_get_action(keypos_t key)
     return action;
 #endif
 }
+
+#ifdef LAYER_ACTION_LATCH
+/*
+ * Action Latch
+ *
+ * Action resolved at press is kept for each key and used at its release,
+ * so that release is paired with its press even if layer state is changed
+ * while the key is held.
+ */
+static action_t action_latch[MATRIX_ROWS][MATRIX_COLS];
+
+action_t layer_event_get_action(keyevent_t event)
+{
+    if (event.pressed) {
+        action_latch[event.key.row][event.key.col] = layer_switch_get_action(event.key);
+    }
+    return action_latch[event.key.row][event.key.col];
+}
+#endif
@@ -74,4 +74,18 @@ void layer_xor(uint32_t state);
 /* return action depending on current layer status */
 action_t layer_switch_get_action(keypos_t key);
 
+/* action for key event, release gets action resolved at its press with LAYER_ACTION_LATCH */
+#ifdef LAYER_ACTION_LATCH
+action_t layer_event_get_action(keyevent_t event);
+#else
+#define layer_event_get_action(event)   layer_switch_get_action((event).key)
+#endif
+
+/* forget actions resolved with LAYER_ACTION_CACHE, needed when keymap is changed */
+#ifdef LAYER_ACTION_CACHE
+void layer_action_cache_clear(void);
+#else
+#define layer_action_cache_clear()
+#endif
+
 #endif
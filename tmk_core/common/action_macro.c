@@ -18,6 +18,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "action_util.h"
 #include "action_macro.h"
 #include "wait.h"
+#include "timer.h"
 
 #ifdef DEBUG_ACTION
 #include "debug.h"
@@ -28,14 +29,33 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #ifndef NO_ACTION_MACRO
 
+/*
+ * Macro player
+ *
+ * Macro is played by macro_step() until it needs to wait for WAIT or
+ * INTERVAL, the wait is kept as time to resume. With ACTION_MACRO_ASYNC
+ * macros are queued and resumed from keyboard_task() so that scanning and
+ * other tasks keep running while macro plays, without it the macro is
+ * played to the end at once.
+ */
+typedef struct {
+    const macro_t *p;
+    uint16_t time;      // time to resume
+    uint8_t interval;
+#ifdef ACTION_MACRO_ASYNC
+    uint8_t mods;       // weak mods held by macro
+#endif
+} macro_player_t;
+
 #define MACRO_READ()  (macro = MACRO_GET(macro_p++))
-void action_macro_play(const macro_t *macro_p)
+/* play commands of macro due by now, return false when macro ends */
+static bool macro_step(macro_player_t *player)
 {
+    const macro_t *macro_p = player->p;
     macro_t macro = END;
-    uint8_t interval = 0;
 
-    if (!macro_p) return;
-    while (true) {
+    while (TIMER_DIFF_16(timer_read(), player->time) < 0x8000) {
+        uint16_t wait = 0;
         switch (MACRO_READ()) {
             case KEY_DOWN:
                 MACRO_READ();
@@ -58,11 +78,11 @@ void action_macro_play(const macro_t *macro_p)
             case WAIT:
                 MACRO_READ();
                 dprintf("WAIT(%u)\n", macro);
-                { uint8_t ms = macro; while (ms--) wait_ms(1); }
+                wait = macro;
                 break;
             case INTERVAL:
-                interval = MACRO_READ();
-                dprintf("INTERVAL(%u)\n", interval);
+                player->interval = MACRO_READ();
+                dprintf("INTERVAL(%u)\n", player->interval);
                 break;
             case 0x04 ... 0x73:
                 dprintf("DOWN(%02X)\n", macro);
@@ -74,10 +94,93 @@ void action_macro_play(const macro_t *macro_p)
                 break;
             case END:
             default:
-                return;
+                return false;
         }
         // interval
-        { uint8_t ms = interval; while (ms--) wait_ms(1); }
+        wait += player->interval;
+        if (wait) {
+            // +1: timer_read() may be just before next tick
+            player->time = timer_read() + wait + 1;
+        }
+        player->p = macro_p;
     }
+    return true;
+}
+
+/* wait until time to resume at once instead of polling timer */
+static void macro_wait(macro_player_t *player)
+{
+    uint16_t ms = TIMER_DIFF_16(player->time, timer_read());
+    // less the tick macro_step() adds for timer_read() just before next tick
+    for (; ms > 1 && ms < 0x8000; ms--) wait_ms(1);
+    player->time = timer_read();
 }
+
+#ifdef ACTION_MACRO_ASYNC
+static macro_player_t macro_queue[MACRO_QUEUE_SIZE];
+static uint8_t macro_head = 0;
+static uint8_t macro_count = 0;
+
+/*
+ * Weak mods of macro are applied only while its step plays, so that mods
+ * held across WAIT don't leak onto keys typed meanwhile. They are dropped
+ * when macro ends.
+ */
+static bool macro_resume(macro_player_t *player)
+{
+    uint8_t mods = get_weak_mods();
+    set_weak_mods(player->mods);
+    bool playing = macro_step(player);
+    player->mods = get_weak_mods();
+    set_weak_mods(mods);
+    if (!playing && player->mods) send_keyboard_report();
+    return playing;
+}
+
+void action_macro_play(const macro_t *macro_p)
+{
+    if (!macro_p) return;
+
+    if (macro_count == MACRO_QUEUE_SIZE) {
+        // play oldest macro to the end to make room
+        dprint("macro queue full\n");
+        while (macro_resume(&macro_queue[macro_head])) macro_wait(&macro_queue[macro_head]);
+        macro_head = (macro_head + 1) % MACRO_QUEUE_SIZE;
+        macro_count--;
+        if (macro_count) macro_queue[macro_head].time = timer_read();
+    }
+    macro_queue[(macro_head + macro_count) % MACRO_QUEUE_SIZE] = (macro_player_t){
+        .p = macro_p,
+        .time = timer_read(),
+        .interval = 0,
+        .mods = 0
+    };
+    macro_count++;
+    action_macro_task();
+}
+
+void action_macro_task(void)
+{
+    while (macro_count) {
+        if (macro_resume(&macro_queue[macro_head])) return;
+        // next macro starts at once
+        macro_head = (macro_head + 1) % MACRO_QUEUE_SIZE;
+        macro_count--;
+        if (macro_count) macro_queue[macro_head].time = timer_read();
+    }
+}
+
+bool action_macro_playing(void)
+{
+    return macro_count;
+}
+#else
+void action_macro_play(const macro_t *macro_p)
+{
+    macro_player_t player = { .p = macro_p, .time = timer_read(), .interval = 0 };
+
+    if (!macro_p) return;
+    while (macro_step(&player)) macro_wait(&player);
+}
+#endif
 #endif
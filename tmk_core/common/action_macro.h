@@ -17,6 +17,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef ACTION_MACRO_H
 #define ACTION_MACRO_H
 #include <stdint.h>
+#include <stdbool.h>
 #include "progmem.h"
 
 
@@ -27,12 +28,27 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 typedef uint8_t macro_t;
 
 
+/* number of macros queued with ACTION_MACRO_ASYNC */
+#ifndef MACRO_QUEUE_SIZE
+#define MACRO_QUEUE_SIZE 4
+#endif
+
+
 #ifndef NO_ACTION_MACRO
 void action_macro_play(const macro_t *macro_p);
 #else
 #define action_macro_play(macro)
 #endif
 
+/* resume queued macros, called from keyboard_task() */
+#if !defined(NO_ACTION_MACRO) && defined(ACTION_MACRO_ASYNC)
+void action_macro_task(void);
+bool action_macro_playing(void);
+#else
+#define action_macro_task()
+#define action_macro_playing()  false
+#endif
+
 
 
 /* Macro commands
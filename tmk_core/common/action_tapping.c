@@ -22,16 +22,23 @@
 
 
 static keyrecord_t tapping_key = {};
+/* tap key settled as hold which can still be tap with TAPPING_RETRO_TAP */
+static keyrecord_t retro_key = {};
 static keyrecord_t waiting_buffer[WAITING_BUFFER_SIZE] = {};
 static uint8_t waiting_buffer_head = 0;
 static uint8_t waiting_buffer_tail = 0;
+static uint8_t waiting_buffer_hwm = 0;
+static uint16_t waiting_buffer_overflow = 0;
 
 static bool process_tapping(keyrecord_t *record);
 static bool waiting_buffer_enq(keyrecord_t record);
-static void waiting_buffer_clear(void);
+static void waiting_buffer_process(void);
 static bool waiting_buffer_typed(keyevent_t event);
 static bool waiting_buffer_has_anykey_pressed(void);
 static void waiting_buffer_scan_tap(void);
+static void tapping_settle(void);
+static uint8_t tapping_key_policy(void);
+static bool retro_tappable(action_t action);
 static void debug_tapping_key(void);
 static void debug_waiting_buffer(void);
 
@@ -43,12 +50,12 @@ void action_tapping_process(keyrecord_t record)
             debug("processed: "); debug_record(record); debug("\n");
         }
     } else {
-        if (!waiting_buffer_enq(record)) {
-            // clear all in case of overflow.
-            debug("OVERFLOW: CLEAR ALL STATES\n");
-            clear_keyboard();
-            waiting_buffer_clear();
-            tapping_key = (keyrecord_t){};
+        while (!waiting_buffer_enq(record)) {
+            // settle tapping as if TAPPING_TERM expired and process buffered events in order to make room
+            debug("OVERFLOW: SETTLE TAPPING\n");
+            if (waiting_buffer_overflow < UINT16_MAX) waiting_buffer_overflow++;
+            tapping_settle();
+            waiting_buffer_process();
         }
     }
 
@@ -56,19 +63,58 @@ void action_tapping_process(keyrecord_t record)
     if (!IS_NOEVENT(record.event) && waiting_buffer_head != waiting_buffer_tail) {
         debug("---- action_exec: process waiting_buffer -----\n");
     }
-    for (; waiting_buffer_tail != waiting_buffer_head; waiting_buffer_tail = (waiting_buffer_tail + 1) % WAITING_BUFFER_SIZE) {
-        if (process_tapping(&waiting_buffer[waiting_buffer_tail])) {
-            debug("processed: waiting_buffer["); debug_dec(waiting_buffer_tail); debug("] = ");
-            debug_record(waiting_buffer[waiting_buffer_tail]); debug("\n\n");
-        } else {
-            break;
-        }
-    }
+    waiting_buffer_process();
     if (!IS_NOEVENT(record.event)) {
         debug("\n");
     }
 }
 
+uint8_t waiting_buffer_high_water(void)
+{
+    return waiting_buffer_hwm;
+}
+
+uint16_t waiting_buffer_overflows(void)
+{
+    return waiting_buffer_overflow;
+}
+
+__attribute__ ((weak))
+uint8_t action_tapping_policy(keypos_t key, action_t action)
+{
+    return TAPPING_POLICY;
+}
+
+static uint8_t tapping_key_policy(void)
+{
+    return action_tapping_policy(tapping_key.event.key, layer_switch_get_action(tapping_key.event.key));
+}
+
+/* tap key with keycode, hold of which can be undone */
+static bool retro_tappable(action_t action)
+{
+    switch (action.kind.id) {
+        case ACT_LMODS_TAP:
+        case ACT_RMODS_TAP:
+            return action.key.code >= KC_A && action.key.code <= 0xdf;
+        case ACT_LAYER_TAP:
+        case ACT_LAYER_TAP_EXT:
+            return action.layer_tap.code >= KC_A && action.layer_tap.code <= 0xdf;
+    }
+    return false;
+}
+
+/* end tapping without waiting for TAPPING_TERM */
+static void tapping_settle(void)
+{
+    if (IS_TAPPING_PRESSED() && tapping_key.tap.count == 0) {
+        debug("Tapping: End. Buffer full. Not tap(0).\n");
+        process_action(&tapping_key);
+    }
+    tapping_key = (keyrecord_t){};
+    debug_tapping_key();
+}
+
 
 /* Tapping
  *
@@ -96,12 +142,12 @@ bool process_tapping(keyrecord_t *keyp)
                     // enqueue
                     return false;
                 }
-#if TAPPING_TERM >= 500
-                /* Process a key typed within TAPPING_TERM
+                /* Process a key typed within TAPPING_TERM with TAPPING_PERMISSIVE_HOLD
                  * This can register the key before settlement of tapping,
                  * useful for long TAPPING_TERM but may prevent fast typing.
                  */
-                else if (IS_RELEASED(event) && waiting_buffer_typed(event)) {
+                else if (IS_RELEASED(event) && waiting_buffer_typed(event) &&
+                        (tapping_key_policy() & TAPPING_PERMISSIVE_HOLD)) {
                     debug("Tapping: End. No tap. Interfered by typing key\n");
                     process_action(&tapping_key);
                     tapping_key = (keyrecord_t){};
@@ -109,14 +155,13 @@ bool process_tapping(keyrecord_t *keyp)
                     // enqueue
                     return false;
                 }
-#endif
                 /* Process release event of a key pressed before tapping starts
                  * Without this unexpected repeating will occur with having fast repeating setting
                  * https://github.com/tmk/tmk_keyboard/issues/60
                  */
                 else if (IS_RELEASED(event) && !waiting_buffer_typed(event)) {
                     // Modifier should be retained till end of this tapping.
-                    action_t action = layer_switch_get_action(event.key);
+                    action_t action = layer_event_get_action(event);
                     switch (action.kind.id) {
                         case ACT_LMODS:
                         case ACT_RMODS:
@@ -134,6 +179,21 @@ bool process_tapping(keyrecord_t *keyp)
                     process_action(keyp);
                     return true;
                 }
+#ifdef TAPPING_BYPASS
+                /* Press of a key which can't tap settles tapping key as hold
+                 * Buffering is needed only to keep order of events with
+                 * the buffer or to decide tap of tap key pressed here.
+                 */
+                else if (event.pressed && waiting_buffer_tail == waiting_buffer_head &&
+                        !is_tap_key(event.key)) {
+                    debug("Tapping: End. Hold. Interrupted by non-tap key\n");
+                    process_action(&tapping_key);
+                    tapping_key = (keyrecord_t){};
+                    debug_tapping_key();
+                    process_action(keyp);
+                    return true;
+                }
+#endif
                 else {
                     // set interrupted flag when other key preesed during tapping
                     if (event.pressed) {
@@ -186,6 +246,10 @@ bool process_tapping(keyrecord_t *keyp)
                 debug("Tapping: End. Timeout. Not tap(0): ");
                 debug_event(event); debug("\n");
                 process_action(&tapping_key);
+                if (!tapping_key.tap.interrupted && (tapping_key_policy() & TAPPING_RETRO_TAP) &&
+                        retro_tappable(layer_switch_get_action(tapping_key.event.key))) {
+                    retro_key = tapping_key;
+                }
                 tapping_key = (keyrecord_t){};
                 debug_tapping_key();
                 return false;
@@ -273,6 +337,23 @@ bool process_tapping(keyrecord_t *keyp)
     }
     // not tapping state
     else {
+        if (!IS_NOEVENT(retro_key.event) && !IS_NOEVENT(event)) {
+            if (KEYEQ(event.key, retro_key.event.key) && !event.pressed) {
+                debug("Tapping: Retro tap.\n");
+                // release hold and then tap
+                process_action(keyp);
+                retro_key.tap.count = 1;
+                retro_key.event.time = event.time;
+                process_action(&retro_key);
+                keyp->tap.count = 1;
+                process_action(keyp);
+                retro_key = (keyrecord_t){};
+                return true;
+            }
+            if (event.pressed) {
+                retro_key = (keyrecord_t){};
+            }
+        }
         if (event.pressed && is_tap_key(event.key)) {
             debug("Tapping: Start(Press tap key).\n");
             tapping_key = *keyp;
@@ -304,14 +385,24 @@ bool waiting_buffer_enq(keyrecord_t record)
     waiting_buffer[waiting_buffer_head] = record;
     waiting_buffer_head = (waiting_buffer_head + 1) % WAITING_BUFFER_SIZE;
 
+    uint8_t count = (waiting_buffer_head + WAITING_BUFFER_SIZE - waiting_buffer_tail) % WAITING_BUFFER_SIZE;
+    if (count > waiting_buffer_hwm) waiting_buffer_hwm = count;
+
     debug("waiting_buffer_enq: "); debug_waiting_buffer();
     return true;
 }
 
-void waiting_buffer_clear(void)
+/* process events in order until one needs to wait */
+void waiting_buffer_process(void)
 {
-    waiting_buffer_head = 0;
-    waiting_buffer_tail = 0;
+    for (; waiting_buffer_tail != waiting_buffer_head; waiting_buffer_tail = (waiting_buffer_tail + 1) % WAITING_BUFFER_SIZE) {
+        if (process_tapping(&waiting_buffer[waiting_buffer_tail])) {
+            debug("processed: waiting_buffer["); debug_dec(waiting_buffer_tail); debug("] = ");
+            debug_record(waiting_buffer[waiting_buffer_tail]); debug("\n\n");
+        } else {
+            break;
+        }
+    }
 }
 
 bool waiting_buffer_typed(keyevent_t event)
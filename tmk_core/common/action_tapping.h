@@ -29,11 +29,37 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define TAPPING_TOGGLE  5
 #endif
 
+/* tapping policy: how tap key is settled besides TAPPING_TERM */
+/* hold when other key is pressed and released while holding tap key */
+#define TAPPING_PERMISSIVE_HOLD (1<<0)
+/* tap when tap key is released after TAPPING_TERM without other key pressed */
+#define TAPPING_RETRO_TAP       (1<<1)
+
+#ifndef TAPPING_POLICY
+#   if TAPPING_TERM >= 500
+#       define TAPPING_POLICY   TAPPING_PERMISSIVE_HOLD
+#   else
+#       define TAPPING_POLICY   0
+#   endif
+#endif
+
+/* size of buffer for events while tapping is undecided, holds size-1 events */
+#ifndef WAITING_BUFFER_SIZE
 #define WAITING_BUFFER_SIZE 8
+#endif
+#if (WAITING_BUFFER_SIZE < 2 || WAITING_BUFFER_SIZE > 255)
+#error "WAITING_BUFFER_SIZE: invalid value"
+#endif
 
 
 #ifndef NO_ACTION_TAPPING
 void action_tapping_process(keyrecord_t record);
+/* policy of tap key, TAPPING_POLICY by default.(optional) */
+uint8_t action_tapping_policy(keypos_t key, action_t action);
+/* max number of events waited in the buffer */
+uint8_t waiting_buffer_high_water(void);
+/* number of times tapping was settled early due to full buffer */
+uint16_t waiting_buffer_overflows(void);
 #endif
 
 #endif
@@ -51,6 +51,26 @@ static int16_t oneshot_time = 0;
 #endif
 #endif
 
+#ifdef KEYBOARD_REPORT_COALESCE
+static bool report_held = false;
+static bool report_dirty = false;
+static report_keyboard_t report_pending = {};
+static report_keyboard_t report_sent = {};
+static uint16_t report_sent_time = 0;
+
+static bool report_equal(report_keyboard_t *a, report_keyboard_t *b);
+static bool report_drops_unsent(report_keyboard_t *cur);
+#endif
+
+static inline void report_send(report_keyboard_t *report)
+{
+#ifdef KEYBOARD_REPORT_COALESCE
+    report_sent = *report;
+    report_sent_time = timer_read();
+#endif
+    host_keyboard_send(report);
+}
+
 
 void send_keyboard_report(void) {
     keyboard_report->mods  = real_mods;
@@ -69,9 +89,48 @@ void send_keyboard_report(void) {
         }
     }
 #endif
-    host_keyboard_send(keyboard_report);
+#ifdef KEYBOARD_REPORT_COALESCE
+    // host must see every press and release, send pending report first
+    if (report_dirty && report_drops_unsent(keyboard_report)) {
+        report_send(&report_pending);
+    }
+    if (report_held) {
+        report_pending = *keyboard_report;
+        report_dirty = !report_equal(&report_pending, &report_sent);
+        return;
+    }
+    report_dirty = false;
+#endif
+    report_send(keyboard_report);
 }
 
+#ifdef KEYBOARD_REPORT_COALESCE
+/* defer keyboard report until flush_keyboard_report() */
+void hold_keyboard_report(void)
+{
+    report_held = true;
+}
+
+/* send deferred keyboard report if it differs from last one sent */
+void flush_keyboard_report(void)
+{
+    report_held = false;
+    if (report_dirty) {
+#if KEYBOARD_REPORT_INTERVAL > 0
+        // keep pending until next call after interval since last report
+        if (TIMER_DIFF_16(timer_read(), report_sent_time) < KEYBOARD_REPORT_INTERVAL) return;
+#endif
+        report_dirty = false;
+        report_send(&report_pending);
+    }
+}
+
+bool keyboard_report_pending(void)
+{
+    return report_dirty;
+}
+#endif
+
 /* key */
 void add_key(uint8_t key)
 {
@@ -286,6 +345,54 @@ static inline void del_key_byte(uint8_t code)
 #endif
 }
 
+#ifdef KEYBOARD_REPORT_COALESCE
+static bool report_equal(report_keyboard_t *a, report_keyboard_t *b)
+{
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_SIZE; i++) {
+        if (a->raw[i] != b->raw[i]) return false;
+    }
+    return true;
+}
+
+static bool report_has_key(report_keyboard_t *report, uint8_t code)
+{
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        if (report->keys[i] == code) return true;
+    }
+    return false;
+}
+
+/*
+ * whether cur undoes a change which is pending but not sent yet: removes a key
+ * or mod pressed since last report, or adds one released since last report
+ */
+static bool report_drops_unsent(report_keyboard_t *cur)
+{
+    if (report_pending.mods & ~report_sent.mods & ~cur->mods) return true;
+    if (report_sent.mods & ~report_pending.mods & cur->mods) return true;
+#ifdef NKRO_ENABLE
+    if (keyboard_nkro) {
+        for (uint8_t i = 0; i < KEYBOARD_REPORT_BITS; i++) {
+            if (report_pending.nkro.bits[i] & ~report_sent.nkro.bits[i] & ~cur->nkro.bits[i])
+                return true;
+            if (report_sent.nkro.bits[i] & ~report_pending.nkro.bits[i] & cur->nkro.bits[i])
+                return true;
+        }
+        return false;
+    }
+#endif
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        uint8_t code = report_pending.keys[i];
+        if (code && !report_has_key(&report_sent, code) && !report_has_key(cur, code))
+            return true;
+        code = report_sent.keys[i];
+        if (code && !report_has_key(&report_pending, code) && report_has_key(cur, code))
+            return true;
+    }
+    return false;
+}
+#endif
+
 #ifdef NKRO_ENABLE
 static inline void add_key_bit(uint8_t code)
 {
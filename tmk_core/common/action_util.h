@@ -18,6 +18,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define ACTION_UTIL_H
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "report.h"
 
 #ifdef __cplusplus
@@ -27,6 +28,23 @@ extern "C" {
 extern report_keyboard_t *keyboard_report;
 
 void send_keyboard_report(void);
+/* merge reports made between hold and flush, implied by KEYBOARD_BATCH_EVENTS */
+#if defined(KEYBOARD_BATCH_EVENTS) && !defined(KEYBOARD_REPORT_COALESCE)
+#   define KEYBOARD_REPORT_COALESCE
+#endif
+/* min time(ms) between flushed reports, 0: at every flush */
+#ifndef KEYBOARD_REPORT_INTERVAL
+#   define KEYBOARD_REPORT_INTERVAL 0
+#endif
+
+#ifdef KEYBOARD_REPORT_COALESCE
+void hold_keyboard_report(void);
+void flush_keyboard_report(void);
+/* report is deferred by KEYBOARD_REPORT_INTERVAL */
+bool keyboard_report_pending(void);
+#else
+#define keyboard_report_pending()   false
+#endif
 
 /* key */
 void add_key(uint8_t key);
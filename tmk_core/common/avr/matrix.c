@@ -0,0 +1,265 @@
+/*
+Copyright 2015 Jun Wako <wakojun@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
+#include "print.h"
+#include "debug.h"
+#include "util.h"
+#include "timer.h"
+#include "matrix.h"
+#include "debounce.h"
+#include "avr/pin_map.h"
+
+
+/*
+ * Generic matrix driver
+ *
+ * Pins are given in config.h with names of avr/pin_map.h:
+ *
+ *     #define MATRIX_ROW_PINS { D0, D1, D2, D3, D4 }
+ *     #define MATRIX_COL_PINS { F0, F1, E6, C7, C6, B6, D4, B1 }
+ *     #define DIODE_DIRECTION COL2ROW
+ *
+ * Strobe lines are driven low one by one and sense lines with pull-up are
+ * read. With COL2ROW(default) rows are strobed and columns are sensed,
+ * ROW2COL is the other way around. Scan is expanded into straight-line
+ * code: select/unselect of a line is single bit operation on DDRx and
+ * sense lines are read with one PINx read for each port.
+ *
+ * With MATRIX_WAKE_ON_KEY all strobe lines are driven low while idle and
+ * pin change interrupt wakes MCU on key press and sets matrix_woken flag. This needs all sense lines
+ * on port B(PCINT0-7), otherwise the keyboard doesn't sleep.
+ */
+#define COL2ROW 0
+#define ROW2COL 1
+
+#ifndef DIODE_DIRECTION
+#   define DIODE_DIRECTION COL2ROW
+#endif
+
+/* settle time(us) after selecting strobe line */
+#ifndef MATRIX_IO_DELAY
+#   define MATRIX_IO_DELAY 30
+#endif
+
+static const uint8_t row_pins[MATRIX_ROWS] = MATRIX_ROW_PINS;
+static const uint8_t col_pins[MATRIX_COLS] = MATRIX_COL_PINS;
+
+#if DIODE_DIRECTION == COL2ROW
+#   define STROBE_PINS  row_pins
+#   define SENSE_PINS   col_pins
+#elif DIODE_DIRECTION == ROW2COL
+#   define STROBE_PINS  col_pins
+#   define SENSE_PINS   row_pins
+#else
+#   error "DIODE_DIRECTION: invalid value"
+#endif
+
+/* matrix state(1:on, 0:off) */
+static matrix_row_t matrix[MATRIX_ROWS];
+static matrix_row_t matrix_debouncing[MATRIX_ROWS];
+/* time when row state changed last(lower 16bit of timer_read_us) */
+static uint16_t matrix_debouncing_time[MATRIX_ROWS];
+/* rows changed since last matrix_changed_rows() */
+static matrix_rows_t matrix_changed = 0;
+
+
+inline
+uint8_t matrix_rows(void)
+{
+    return MATRIX_ROWS;
+}
+
+inline
+uint8_t matrix_cols(void)
+{
+    return MATRIX_COLS;
+}
+
+void matrix_init(void)
+{
+    // unselect strobe lines: Hi-Z(DDR:0, PORT:0), select only sets DDR
+    pins_hiz(STROBE_PINS, PINS_COUNT(STROBE_PINS));
+    pins_input_pullup(SENSE_PINS, PINS_COUNT(SENSE_PINS));
+
+    // initialize matrix state: all keys off
+    for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+        matrix[i] = 0;
+        matrix_debouncing[i] = 0;
+    }
+    debounce_init();
+}
+
+#ifdef MATRIX_WAKE_ON_KEY
+/* PCINT0-7 mask of sense lines, 0 when any of them is not on port B */
+#define WAKE_BIT_(pins, n, arg) \
+    ((n) < PINS_COUNT(pins) ? PIN_MASK(PINS_GET(pins, n)) : 0) |
+#define WAKE_OK_(pins, n, arg) \
+    ((n) >= PINS_COUNT(pins) || PIN_PORT(PINS_GET(pins, n)) == 1) &&
+#define WAKE_MASK \
+    ((PINS_EACH(WAKE_OK_, SENSE_PINS, 0) 1) ? (PINS_EACH(WAKE_BIT_, SENSE_PINS, 0) 0) : 0)
+
+static volatile bool woken = false;
+
+bool matrix_wake_arm(void)
+{
+    if (!WAKE_MASK) return false;
+    if (debounce_active()) return false;
+    for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+        if (matrix[i]) return false;
+    }
+
+    pins_output_low(STROBE_PINS, PINS_COUNT(STROBE_PINS));
+    woken = false;
+    PCMSK0 = WAKE_MASK;
+    PCIFR  = (1<<PCIF0);
+    PCICR |= (1<<PCIE0);
+    _delay_us(MATRIX_IO_DELAY);
+
+    // key pressed before arming gives no edge
+    if (PINS_READ_LOW(SENSE_PINS)) {
+        matrix_wake_disarm();
+        return false;
+    }
+    return true;
+}
+
+/* edge may be missed while interrupt runs, check lines too */
+bool matrix_woken(void)
+{
+    return woken || PINS_READ_LOW(SENSE_PINS);
+}
+
+void matrix_wake_disarm(void)
+{
+    PCICR &= ~(1<<PCIE0);
+    PCMSK0 = 0;
+    pins_hiz(STROBE_PINS, PINS_COUNT(STROBE_PINS));
+}
+
+/* only to wake MCU, next matrix_scan() reads the key */
+ISR(PCINT0_vect)
+{
+    PCICR &= ~(1<<PCIE0);
+    woken = true;
+}
+#endif
+
+static inline uint32_t read_sense(void)
+{
+    return PINS_READ_LOW(SENSE_PINS);
+}
+
+/* strobe n-th line: Output low(DDR:1, PORT:0) */
+#define SCAN_LINE_(pins, n, sense) \
+    if ((n) < PINS_COUNT(pins)) { \
+        DDR_REG(PINS_GET(pins, n)) |=  PIN_MASK(PINS_GET(pins, n)); \
+        _delay_us(MATRIX_IO_DELAY); \
+        sense[(n) < PINS_COUNT(pins) ? (n) : 0] = read_sense(); \
+        DDR_REG(PINS_GET(pins, n)) &= ~PIN_MASK(PINS_GET(pins, n)); \
+    }
+
+uint8_t matrix_scan(void)
+{
+#if DIODE_DIRECTION == COL2ROW
+    matrix_row_t raw[MATRIX_ROWS];
+    PINS_EACH(SCAN_LINE_, STROBE_PINS, raw)
+#else
+    uint32_t sense[MATRIX_COLS];
+    PINS_EACH(SCAN_LINE_, STROBE_PINS, sense)
+
+    matrix_row_t raw[MATRIX_ROWS];
+    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+        raw[r] = 0;
+        for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+            if (sense[c] & ((uint32_t)1<<r)) raw[r] |= ((matrix_row_t)1<<c);
+        }
+    }
+#endif
+
+    uint16_t now = timer_read_us();
+    for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+        if (matrix_debouncing[i] != raw[i]) {
+            matrix_debouncing[i] = raw[i];
+            matrix_debouncing_time[i] = now;
+        } else if ((uint16_t)(now - matrix_debouncing_time[i]) > MATRIX_ROW_TIME_AGE_MAX) {
+            // debounce may hold the change longer than the time can tell
+            matrix_debouncing_time[i] = now - MATRIX_ROW_TIME_AGE_MAX;
+        }
+    }
+
+    matrix_changed |= debounce(matrix_debouncing, matrix);
+
+    return 1;
+}
+
+bool matrix_is_modified(void)
+{
+    if (debounce_active()) return false;
+    return true;
+}
+
+inline
+bool matrix_is_on(uint8_t row, uint8_t col)
+{
+    return (matrix[row] & ((matrix_row_t)1<<col));
+}
+
+inline
+matrix_row_t matrix_get_row(uint8_t row)
+{
+    return matrix[row];
+}
+
+uint16_t matrix_get_row_time(uint8_t row)
+{
+    // row is committed on the scan its last change settles
+    return matrix_debouncing_time[row];
+}
+
+matrix_rows_t matrix_changed_rows(void)
+{
+    matrix_rows_t changed = matrix_changed;
+    matrix_changed = 0;
+    return changed;
+}
+
+void matrix_print(void)
+{
+    print("\nr/c 0123456789ABCDEF\n");
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        phex(row); print(": ");
+#if (MATRIX_COLS <= 16)
+        print_bin_reverse16(matrix_get_row(row));
+#else
+        print_bin_reverse32(matrix_get_row(row));
+#endif
+        print("\n");
+    }
+}
+
+uint8_t matrix_key_count(void)
+{
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+        count += bitpop32(matrix[i]);
+    }
+    return count;
+}
@@ -0,0 +1,137 @@
+/*
+Copyright 2015 Jun Wako <wakojun@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "matrix.h"
+#include "matrix_isr.h"
+
+
+#ifdef MATRIX_SCAN_ISR
+/*
+ * Matrix scan in timer interrupt
+ *
+ * matrix_scan() is called at fixed rate of MATRIX_SCAN_RATE regardless of
+ * main loop and the result is stored in ISR side buffer. Main loop copies
+ * it to its own buffer with matrix_isr_fetch() and retries when the ISR
+ * updates during the copy, so no interrupt is disabled for it.
+ *
+ * Timer3 is used when available, otherwise Timer1.
+ */
+#if defined(TCCR3A)
+#   define SCAN_TCCRA   TCCR3A
+#   define SCAN_TCCRB   TCCR3B
+#   define SCAN_OCRA    OCR3A
+#   define SCAN_TIMSK   TIMSK3
+#   define SCAN_OCIEA   OCIE3A
+#   define SCAN_WGM     WGM32
+#   define SCAN_CS      CS31
+#   define SCAN_vect    TIMER3_COMPA_vect
+#else
+#   ifdef SLEEP_LED_ENABLE
+#       error "MATRIX_SCAN_ISR: Timer1 is used by SLEEP_LED_ENABLE on this MCU"
+#   endif
+#   define SCAN_TCCRA   TCCR1A
+#   define SCAN_TCCRB   TCCR1B
+#   define SCAN_OCRA    OCR1A
+#   define SCAN_TIMSK   TIMSK1
+#   define SCAN_OCIEA   OCIE1A
+#   define SCAN_WGM     WGM12
+#   define SCAN_CS      CS11
+#   define SCAN_vect    TIMER1_COMPA_vect
+#endif
+
+/* CTC mode with prescaler 8 */
+#define SCAN_TOP    (F_CPU/8/MATRIX_SCAN_RATE - 1)
+#if SCAN_TOP > 0xFFFF || SCAN_TOP < 1
+#   error "MATRIX_SCAN_RATE: invalid value"
+#endif
+
+/* written by ISR */
+static matrix_row_t isr_rows[MATRIX_ROWS];
+static uint16_t isr_row_time[MATRIX_ROWS];
+static volatile uint8_t isr_seq = 0;
+static volatile bool isr_scanning = false;
+
+/* fetched by main loop */
+static matrix_row_t rows[MATRIX_ROWS];
+static uint16_t row_time[MATRIX_ROWS];
+
+
+void matrix_isr_start(void)
+{
+    SCAN_TCCRA = 0;
+    SCAN_TCCRB = (1<<SCAN_WGM) | (1<<SCAN_CS);
+    SCAN_OCRA = SCAN_TOP;
+    SCAN_TIMSK |= (1<<SCAN_OCIEA);
+}
+
+void matrix_isr_stop(void)
+{
+    // no scan is in progress: called from main loop, which doesn't run until
+    // the scan interrupt returns
+    SCAN_TIMSK &= ~(1<<SCAN_OCIEA);
+}
+
+matrix_rows_t matrix_isr_fetch(void)
+{
+    matrix_rows_t changed = 0;
+    uint8_t seq;
+    do {
+        seq = isr_seq;
+        for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+            matrix_row_t state = *(volatile matrix_row_t *)&isr_rows[r];
+            if (rows[r] != state) {
+                rows[r] = state;
+                changed |= ((matrix_rows_t)1<<r);
+            }
+            row_time[r] = *(volatile uint16_t *)&isr_row_time[r];
+        }
+    } while (seq != isr_seq);
+    return changed;
+}
+
+matrix_row_t matrix_isr_get_row(uint8_t row)
+{
+    return rows[row];
+}
+
+uint16_t matrix_isr_get_row_time(uint8_t row)
+{
+    return row_time[row];
+}
+
+/* other interrupts like USB and timer0 are allowed during scan */
+ISR(SCAN_vect, ISR_NOBLOCK)
+{
+    if (isr_scanning) return;
+    isr_scanning = true;
+
+    matrix_scan();
+    matrix_rows_t changed = matrix_changed_rows();
+    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+        if (changed & ((matrix_rows_t)1<<r)) {
+            isr_rows[r] = matrix_get_row(r);
+            isr_row_time[r] = matrix_get_row_time(r);
+        }
+    }
+    isr_seq++;
+
+    isr_scanning = false;
+}
+#endif
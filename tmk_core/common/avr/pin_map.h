@@ -0,0 +1,170 @@
+/*
+Copyright 2015 Jun Wako <wakojun@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PIN_MAP_H
+#define PIN_MAP_H
+
+#include <stdint.h>
+#include <avr/io.h>
+
+
+/*
+ * Pin map
+ *
+ * Pin is given as I/O address of its PINx register and bit number so that
+ * pins can be listed in config.h, for example:
+ *
+ *     #define MATRIX_COL_PINS { F0, F1, E6, C7, C6, B6, D4 }
+ *     static const uint8_t col_pins[MATRIX_COLS] = MATRIX_COL_PINS;
+ *
+ * PINS_READ_LOW() on such a table is folded at compile time into one PINx
+ * read for each port in use and a bit test for each pin.
+ *
+ * I/O addresses are those of megaAVR with port A-F at 0x00-0x0F like
+ * ATmega32U4, AT90USB and ATmega328P.
+ */
+#define PIN_DEF(addr, bit)  ((addr) << 3 | (bit))
+#define PIN_ADDR(pin)       ((pin) >> 3)
+#define PIN_BIT(pin)        ((pin) & 7)
+#define PIN_MASK(pin)       (1<<PIN_BIT(pin))
+/* port index: A=0, B=1 ... F=5 */
+#define PIN_PORT(pin)       (PIN_ADDR(pin) / 3)
+
+#define PIN_REG(pin)        _SFR_IO8(PIN_ADDR(pin))
+#define DDR_REG(pin)        _SFR_IO8(PIN_ADDR(pin) + 1)
+#define PORT_REG(pin)       _SFR_IO8(PIN_ADDR(pin) + 2)
+
+#define A0  PIN_DEF(0x00, 0)
+#define A1  PIN_DEF(0x00, 1)
+#define A2  PIN_DEF(0x00, 2)
+#define A3  PIN_DEF(0x00, 3)
+#define A4  PIN_DEF(0x00, 4)
+#define A5  PIN_DEF(0x00, 5)
+#define A6  PIN_DEF(0x00, 6)
+#define A7  PIN_DEF(0x00, 7)
+#define B0  PIN_DEF(0x03, 0)
+#define B1  PIN_DEF(0x03, 1)
+#define B2  PIN_DEF(0x03, 2)
+#define B3  PIN_DEF(0x03, 3)
+#define B4  PIN_DEF(0x03, 4)
+#define B5  PIN_DEF(0x03, 5)
+#define B6  PIN_DEF(0x03, 6)
+#define B7  PIN_DEF(0x03, 7)
+#define C0  PIN_DEF(0x06, 0)
+#define C1  PIN_DEF(0x06, 1)
+#define C2  PIN_DEF(0x06, 2)
+#define C3  PIN_DEF(0x06, 3)
+#define C4  PIN_DEF(0x06, 4)
+#define C5  PIN_DEF(0x06, 5)
+#define C6  PIN_DEF(0x06, 6)
+#define C7  PIN_DEF(0x06, 7)
+#define D0  PIN_DEF(0x09, 0)
+#define D1  PIN_DEF(0x09, 1)
+#define D2  PIN_DEF(0x09, 2)
+#define D3  PIN_DEF(0x09, 3)
+#define D4  PIN_DEF(0x09, 4)
+#define D5  PIN_DEF(0x09, 5)
+#define D6  PIN_DEF(0x09, 6)
+#define D7  PIN_DEF(0x09, 7)
+#define E0  PIN_DEF(0x0C, 0)
+#define E1  PIN_DEF(0x0C, 1)
+#define E2  PIN_DEF(0x0C, 2)
+#define E3  PIN_DEF(0x0C, 3)
+#define E4  PIN_DEF(0x0C, 4)
+#define E5  PIN_DEF(0x0C, 5)
+#define E6  PIN_DEF(0x0C, 6)
+#define E7  PIN_DEF(0x0C, 7)
+#define F0  PIN_DEF(0x0F, 0)
+#define F1  PIN_DEF(0x0F, 1)
+#define F2  PIN_DEF(0x0F, 2)
+#define F3  PIN_DEF(0x0F, 3)
+#define F4  PIN_DEF(0x0F, 4)
+#define F5  PIN_DEF(0x0F, 5)
+#define F6  PIN_DEF(0x0F, 6)
+#define F7  PIN_DEF(0x0F, 7)
+/* placeholder beyond end of table, matches no port */
+#define NO_PIN  0xFF
+
+
+/* number of pins in table and n-th pin, NO_PIN beyond the end */
+#define PINS_COUNT(pins)    (sizeof(pins)/sizeof((pins)[0]))
+#define PINS_GET(pins, n)   ((n) < PINS_COUNT(pins) ? (pins)[(n) < PINS_COUNT(pins) ? (n) : 0] : NO_PIN)
+
+/* expand M(pins, n, arg) for n = 0..31 */
+#define PINS_EACH(M, pins, arg) \
+    M(pins, 0, arg)  M(pins, 1, arg)  M(pins, 2, arg)  M(pins, 3, arg)  \
+    M(pins, 4, arg)  M(pins, 5, arg)  M(pins, 6, arg)  M(pins, 7, arg)  \
+    M(pins, 8, arg)  M(pins, 9, arg)  M(pins, 10, arg) M(pins, 11, arg) \
+    M(pins, 12, arg) M(pins, 13, arg) M(pins, 14, arg) M(pins, 15, arg) \
+    M(pins, 16, arg) M(pins, 17, arg) M(pins, 18, arg) M(pins, 19, arg) \
+    M(pins, 20, arg) M(pins, 21, arg) M(pins, 22, arg) M(pins, 23, arg) \
+    M(pins, 24, arg) M(pins, 25, arg) M(pins, 26, arg) M(pins, 27, arg) \
+    M(pins, 28, arg) M(pins, 29, arg) M(pins, 30, arg) M(pins, 31, arg)
+
+#define PINS_USE_(pins, n, port)    (PIN_PORT(PINS_GET(pins, n)) == (port)) ||
+#define PINS_USE_PORT(pins, port)   (PINS_EACH(PINS_USE_, pins, port) 0)
+
+#define PINS_BIT_(pins, n, val) \
+    (((n) < PINS_COUNT(pins) && \
+      (val[PIN_PORT(PINS_GET(pins, n)) % 6] & PIN_MASK(PINS_GET(pins, n)))) ? ((uint32_t)1<<(n)) : 0) |
+
+/* read port only when any pin of table is on it */
+#define PINS_READ_PORT_(pins, val, port) \
+    if (PINS_USE_PORT(pins, port)) val[port] = ~_SFR_IO8((port) * 3)
+
+/* bitmap of pins which read low, bit n for n-th pin of table */
+#define PINS_READ_LOW(pins) ({ \
+    uint8_t pins_val_[6] = { 0 }; \
+    PINS_READ_PORT_(pins, pins_val_, 0); \
+    PINS_READ_PORT_(pins, pins_val_, 1); \
+    PINS_READ_PORT_(pins, pins_val_, 2); \
+    PINS_READ_PORT_(pins, pins_val_, 3); \
+    PINS_READ_PORT_(pins, pins_val_, 4); \
+    PINS_READ_PORT_(pins, pins_val_, 5); \
+    (PINS_EACH(PINS_BIT_, pins, pins_val_) 0); \
+})
+
+
+/* pin setup, these are not folded and meant for initialization */
+static inline void pins_input_pullup(const uint8_t pins[], uint8_t count)
+{
+    // Input with pull-up(DDR:0, PORT:1)
+    for (uint8_t i = 0; i < count; i++) {
+        DDR_REG(pins[i])  &= ~PIN_MASK(pins[i]);
+        PORT_REG(pins[i]) |=  PIN_MASK(pins[i]);
+    }
+}
+
+static inline void pins_output_low(const uint8_t pins[], uint8_t count)
+{
+    // Output low(DDR:1, PORT:0)
+    for (uint8_t i = 0; i < count; i++) {
+        PORT_REG(pins[i]) &= ~PIN_MASK(pins[i]);
+        DDR_REG(pins[i])  |=  PIN_MASK(pins[i]);
+    }
+}
+
+static inline void pins_hiz(const uint8_t pins[], uint8_t count)
+{
+    // Hi-Z(DDR:0, PORT:0)
+    for (uint8_t i = 0; i < count; i++) {
+        DDR_REG(pins[i])  &= ~PIN_MASK(pins[i]);
+        PORT_REG(pins[i]) &= ~PIN_MASK(pins[i]);
+    }
+}
+
+#endif
@@ -8,6 +8,7 @@
 #include "suspend_avr.h"
 #include "suspend.h"
 #include "timer.h"
+#include "matrix_isr.h"
 #ifdef PROTOCOL_LUFA
 #include "lufa.h"
 #endif
@@ -82,6 +83,10 @@ static void power_down(uint8_t wdto)
 
 void suspend_power_down(void)
 {
+#ifdef MATRIX_SCAN_ISR
+    // matrix is scanned by suspend_wakeup_condition() during suspend
+    matrix_isr_stop();
+#endif
     power_down(WDTO_15MS);
 }
 
@@ -106,6 +111,9 @@ void suspend_wakeup_init(void)
 #ifdef BACKLIGHT_ENABLE
     backlight_init();
 #endif
+#ifdef MATRIX_SCAN_ISR
+    matrix_isr_start();
+#endif
 }
 
 #ifndef NO_SUSPEND_POWER_DOWN
@@ -34,6 +34,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define TIMER_RAW_FREQ      (F_CPU/TIMER_PRESCALER)
 #define TIMER_RAW           TCNT0
 #define TIMER_RAW_TOP       (TIMER_RAW_FREQ/1000)
+/* raw timer count to microseconds */
+#if (1000000 % TIMER_RAW_FREQ == 0)
+#   define TIMER_RAW_US(raw)    ((uint16_t)(raw) * (1000000/TIMER_RAW_FREQ))
+#else
+#   define TIMER_RAW_US(raw)    ((uint16_t)((uint32_t)(raw) * 1000000 / TIMER_RAW_FREQ))
+#endif
 
 #if (TIMER_RAW_TOP > 255)
 #   error "Timer0 can't count 1ms at this clock freq. Use larger prescaler."
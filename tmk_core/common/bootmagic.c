@@ -18,6 +18,9 @@ void bootmagic(void)
         eeconfig_init();
     }
 
+    /* keycode remap without swap in case bootmagic is skipped */
+    keymap_remap_update();
+
     /* do scans in case of bounce */
     print("boogmagic scan: ... ");
     uint8_t scan = 100;
@@ -81,6 +84,7 @@ void bootmagic(void)
         keymap_config.nkro = !keymap_config.nkro;
     }
     eeconfig_write_keymap(keymap_config.raw);
+    keymap_remap_update();
 
 #ifdef NKRO_ENABLE
     keyboard_nkro = keymap_config.nkro;
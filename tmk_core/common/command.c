@@ -28,11 +28,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "bootloader.h"
 #include "action_layer.h"
 #include "action_util.h"
+#include "action_tapping.h"
 #include "eeconfig.h"
 #include "sleep_led.h"
 #include "led.h"
 #include "command.h"
 #include "backlight.h"
+#include "profile.h"
+#include "trace.h"
 
 #ifdef MOUSEKEY_ENABLE
 #include "mousekey.h"
@@ -49,6 +52,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #   include "usbdrv.h"
 #endif
 
+#ifdef PROTOCOL_LUFA
+#   include "lufa.h"
+#endif
+
 
 static bool command_common(uint8_t code);
 static void command_common_help(void);
@@ -138,6 +145,18 @@ static void command_common_help(void)
 #ifdef SLEEP_LED_ENABLE
           "z:	sleep LED test\n"
 #endif
+
+#ifdef PROFILE_ENABLE
+          "t:	loop timing\n"
+#endif
+
+#ifdef TRACE_ENABLE
+          "r:	key event trace\n"
+#endif
+
+#ifdef TRACE_EEPROM
+          "w:	save trace to eeprom\n"
+#endif
     );
 }
 
@@ -194,6 +213,24 @@ static bool command_common(uint8_t code)
             print_eeconfig();
             break;
 #endif
+#ifdef PROFILE_ENABLE
+        case KC_T:
+            // print loop timing and start new measurement
+            profile_print();
+            profile_clear();
+            break;
+#endif
+#ifdef TRACE_ENABLE
+        case KC_R:
+            trace_print();
+            break;
+#endif
+#ifdef TRACE_EEPROM
+        case KC_W:
+            trace_save();
+            print("trace saved\n");
+            break;
+#endif
 #ifdef KEYBOARD_LOCK_ENABLE
         case KC_CAPSLOCK:
             if (host_get_driver()) {
@@ -303,6 +340,12 @@ static bool command_common(uint8_t code)
 #endif
 #ifdef KEYMAP_SECTION_ENABLE
             " KEYMAP_SECTION"
+#endif
+#ifdef PROFILE_ENABLE
+            " PROFILE"
+#endif
+#ifdef TRACE_ENABLE
+            " TRACE"
 #endif
             " " STR(BOOTLOADER_SIZE) "\n");
 
@@ -316,6 +359,10 @@ static bool command_common(uint8_t code)
             print_val_hex8(keyboard_protocol);
             print_val_hex8(keyboard_idle);
             print_val_hex32(timer_count);
+#ifndef NO_ACTION_TAPPING
+            print_val_dec(waiting_buffer_high_water());
+            print_val_dec(waiting_buffer_overflows());
+#endif
 
 #ifdef PROTOCOL_PJRC
             print_val_hex8(UDCON);
@@ -325,6 +372,10 @@ static bool command_common(uint8_t code)
             print_val_hex8(usb_keyboard_idle_count);
 #endif
 
+#if defined(PROTOCOL_LUFA) && defined(LUFA_REPORT_QUEUE)
+            print_val_dec(lufa_report_overflows());
+#endif
+
 #ifdef PROTOCOL_PJRC
 #   if USB_COUNT_SOF
             print_val_hex8(usbSofCount);
@@ -0,0 +1,242 @@
+/*
+Copyright 2015 Jun Wako <wakojun@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "timer.h"
+#include "matrix.h"
+#include "debounce.h"
+
+
+/*
+ * Debounce
+ *
+ * Time of the last change is compared with timer on every scan instead of
+ * counting down with delay in matrix_scan(), so that main loop is not
+ * stalled while bouncing and a change is reported on the first sample after
+ * it settles.
+ */
+#if DEBOUNCE_ALGORITHM == DEBOUNCE_GLOBAL
+static matrix_row_t last_raw[MATRIX_ROWS];
+static bool debouncing = false;
+static uint16_t debouncing_time;
+
+void debounce_init(void)
+{
+    for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+        last_raw[i] = 0;
+    }
+    debouncing = false;
+}
+
+void debounce_begin(void)
+{
+}
+
+bool debounce_row(uint8_t row, matrix_row_t raw, matrix_row_t *cooked)
+{
+    if (last_raw[row] != raw) {
+        last_raw[row] = raw;
+        debouncing = true;
+        debouncing_time = timer_read();
+    }
+    // rows are updated together in debounce_end()
+    return false;
+}
+
+matrix_rows_t debounce_end(matrix_row_t cooked[])
+{
+    if (!debouncing || timer_elapsed(debouncing_time) < DEBOUNCE)
+        return 0;
+
+    debouncing = false;
+    matrix_rows_t changed = 0;
+    for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+        if (cooked[i] != last_raw[i]) {
+            cooked[i] = last_raw[i];
+            changed |= ((matrix_rows_t)1<<i);
+        }
+    }
+    return changed;
+}
+
+bool debounce_active(void)
+{
+    return debouncing;
+}
+
+#elif DEBOUNCE_ALGORITHM == DEBOUNCE_ROW
+static matrix_row_t last_raw[MATRIX_ROWS];
+static uint16_t row_time[MATRIX_ROWS];
+static bool row_debouncing[MATRIX_ROWS];
+
+void debounce_init(void)
+{
+    for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+        last_raw[i] = 0;
+        row_debouncing[i] = false;
+    }
+}
+
+static uint16_t scan_time;
+
+void debounce_begin(void)
+{
+    scan_time = timer_read();
+}
+
+bool debounce_row(uint8_t row, matrix_row_t raw, matrix_row_t *cooked)
+{
+    if (last_raw[row] != raw) {
+        last_raw[row] = raw;
+        row_debouncing[row] = true;
+        row_time[row] = scan_time;
+    } else if (row_debouncing[row] && TIMER_DIFF_16(scan_time, row_time[row]) >= DEBOUNCE) {
+        row_debouncing[row] = false;
+        if (*cooked != raw) {
+            *cooked = raw;
+            return true;
+        }
+    }
+    return false;
+}
+
+matrix_rows_t debounce_end(matrix_row_t cooked[])
+{
+    return 0;
+}
+
+bool debounce_active(void)
+{
+    for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+        if (row_debouncing[i]) return true;
+    }
+    return false;
+}
+
+#elif DEBOUNCE_ALGORITHM == DEBOUNCE_KEY
+/*
+ * Press is taken on the first edge and the key is locked out for
+ * DEBOUNCE_LOCKOUT so that its bounces are ignored. Release is taken when
+ * the key reads off for DEBOUNCE after the lockout.
+ *
+ * Each key has 3bit down counter(ms) and they are stored in bit planes
+ * like matrix rows, counters of a row are updated at once with bitwise
+ * operations.
+ */
+#if DEBOUNCE > 7 || DEBOUNCE_LOCKOUT > 7
+#   error "DEBOUNCE and DEBOUNCE_LOCKOUT must be 7 or less with DEBOUNCE_KEY"
+#endif
+/* keys in lockout after press */
+static matrix_row_t locked[MATRIX_ROWS];
+/* bit planes of counters */
+static matrix_row_t count0[MATRIX_ROWS];
+static matrix_row_t count1[MATRIX_ROWS];
+static matrix_row_t count2[MATRIX_ROWS];
+static uint8_t last_tick;
+static uint8_t scan_ticks;
+static bool debouncing = false;
+
+static inline matrix_row_t count_nonzero(uint8_t i)
+{
+    return count0[i] | count1[i] | count2[i];
+}
+
+static inline void count_load(uint8_t i, matrix_row_t mask, uint8_t value)
+{
+    count0[i] = (count0[i] & ~mask) | ((value & 1) ? mask : 0);
+    count1[i] = (count1[i] & ~mask) | ((value & 2) ? mask : 0);
+    count2[i] = (count2[i] & ~mask) | ((value & 4) ? mask : 0);
+}
+
+static inline void count_down(uint8_t i)
+{
+    matrix_row_t borrow = count_nonzero(i);
+    count0[i] ^= borrow; borrow &= count0[i];
+    count1[i] ^= borrow; borrow &= count1[i];
+    count2[i] ^= borrow;
+}
+
+void debounce_init(void)
+{
+    for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+        locked[i] = 0;
+        count_load(i, ~(matrix_row_t)0, 0);
+    }
+    last_tick = timer_read();
+    debouncing = false;
+}
+
+void debounce_begin(void)
+{
+    uint8_t now = timer_read();
+    scan_ticks = now - last_tick;
+    last_tick = now;
+    if (scan_ticks > 7) scan_ticks = 7;
+    debouncing = false;
+}
+
+bool debounce_row(uint8_t i, matrix_row_t raw, matrix_row_t *cooked)
+{
+    bool changed = false;
+    for (uint8_t t = 0; t < scan_ticks; t++) {
+        count_down(i);
+    }
+
+    // lockout expired: start release debounce
+    matrix_row_t expired = locked[i] & ~count_nonzero(i);
+    locked[i] &= ~expired;
+    count_load(i, expired, DEBOUNCE);
+
+    // reload release counter while the key reads on
+    count_load(i, *cooked & raw & ~locked[i], DEBOUNCE);
+
+    matrix_row_t release = *cooked & ~raw & ~locked[i] & ~count_nonzero(i);
+    matrix_row_t press = raw & ~*cooked;
+    if (release || press) {
+        *cooked = (*cooked & ~release) | press;
+        locked[i] |= press;
+        count_load(i, press, DEBOUNCE_LOCKOUT);
+        changed = true;
+    }
+
+    if (locked[i] || (*cooked & ~raw)) debouncing = true;
+    return changed;
+}
+
+matrix_rows_t debounce_end(matrix_row_t cooked[])
+{
+    return 0;
+}
+
+bool debounce_active(void)
+{
+    return debouncing;
+}
+
+#else
+#   error "Unknown DEBOUNCE_ALGORITHM"
+#endif
+
+matrix_rows_t debounce(const matrix_row_t raw[], matrix_row_t cooked[])
+{
+    matrix_rows_t changed = 0;
+    debounce_begin();
+    for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+        if (debounce_row(i, raw[i], &cooked[i])) changed |= ((matrix_rows_t)1<<i);
+    }
+    return changed | debounce_end(cooked);
+}
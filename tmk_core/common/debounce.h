@@ -0,0 +1,70 @@
+/*
+Copyright 2015 Jun Wako <wakojun@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef DEBOUNCE_H
+#define DEBOUNCE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "matrix.h"
+
+
+/* debounce time(ms) */
+#ifndef DEBOUNCE
+#   define DEBOUNCE 5
+#endif
+
+/* algorithms */
+#define DEBOUNCE_GLOBAL     0   /* all rows are updated when whole matrix is stable for DEBOUNCE */
+#define DEBOUNCE_ROW        1   /* row is updated when the row is stable for DEBOUNCE */
+#define DEBOUNCE_KEY        2   /* press is reported at once, release when the key is stable for DEBOUNCE */
+
+/* DEBOUNCE_KEY: time(ms) to ignore the key after press */
+#ifndef DEBOUNCE_LOCKOUT
+#   define DEBOUNCE_LOCKOUT DEBOUNCE
+#endif
+
+#ifndef DEBOUNCE_ALGORITHM
+#   define DEBOUNCE_ALGORITHM DEBOUNCE_GLOBAL
+#endif
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void debounce_init(void);
+/*
+ * Update debounced state 'cooked' with rows read in this scan 'raw'.
+ * This never waits, call it on every scan. Returns rows changed in 'cooked'.
+ */
+matrix_rows_t debounce(const matrix_row_t raw[], matrix_row_t cooked[]);
+/*
+ * Same as debounce() in steps, so that driver can debounce a row while the
+ * next row settles: call debounce_begin(), debounce_row() for every row and
+ * then debounce_end(). debounce_row() returns true when 'cooked' row changed.
+ */
+void debounce_begin(void);
+bool debounce_row(uint8_t row, matrix_row_t raw, matrix_row_t *cooked);
+matrix_rows_t debounce_end(matrix_row_t cooked[]);
+/* whether any change is still waiting to be settled */
+bool debounce_active(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
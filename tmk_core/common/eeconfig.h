@@ -31,6 +31,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define EECONFIG_KEYMAP                             (uint8_t *)4
 #define EECONFIG_MOUSEKEY_ACCEL                     (uint8_t *)5
 #define EECONFIG_BACKLIGHT                          (uint8_t *)6
+/* key event trace area: length, head and records */
+#define EECONFIG_TRACE_ADDR                         16
+#define EECONFIG_TRACE                              (uint8_t *)EECONFIG_TRACE_ADDR
 
 
 /* debug bit */
@@ -21,6 +21,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "host.h"
 #include "util.h"
 #include "debug.h"
+#include "profile.h"
 
 
 #ifdef NKRO_ENABLE
@@ -51,7 +52,9 @@ uint8_t host_keyboard_leds(void)
 void host_keyboard_send(report_keyboard_t *report)
 {
     if (!driver) return;
+    PROFILE_BEGIN(PROFILE_HOST_SEND);
     (*driver->send_keyboard)(report);
+    PROFILE_END(PROFILE_HOST_SEND);
 
     if (debug_keyboard) {
         dprint("keyboard_report: ");
@@ -65,7 +68,9 @@ void host_keyboard_send(report_keyboard_t *report)
 void host_mouse_send(report_mouse_t *report)
 {
     if (!driver) return;
+    PROFILE_BEGIN(PROFILE_HOST_SEND);
     (*driver->send_mouse)(report);
+    PROFILE_END(PROFILE_HOST_SEND);
 }
 
 void host_system_send(uint16_t report)
@@ -74,7 +79,9 @@ void host_system_send(uint16_t report)
     last_system_report = report;
 
     if (!driver) return;
+    PROFILE_BEGIN(PROFILE_HOST_SEND);
     (*driver->send_system)(report);
+    PROFILE_END(PROFILE_HOST_SEND);
 }
 
 void host_consumer_send(uint16_t report)
@@ -83,7 +90,9 @@ void host_consumer_send(uint16_t report)
     last_consumer_report = report;
 
     if (!driver) return;
+    PROFILE_BEGIN(PROFILE_HOST_SEND);
     (*driver->send_consumer)(report);
+    PROFILE_END(PROFILE_HOST_SEND);
 }
 
 uint16_t host_last_sysytem_report(void)
@@ -17,6 +17,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <stdint.h>
 #include "keyboard.h"
 #include "matrix.h"
+#include "matrix_ghost.h"
 #include "keymap.h"
 #include "host.h"
 #include "led.h"
@@ -30,6 +31,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "bootmagic.h"
 #include "eeconfig.h"
 #include "backlight.h"
+#include "action_util.h"
+#include "profile.h"
+#include "trace.h"
+#include "matrix_isr.h"
+#include "suspend.h"
 #ifdef MOUSEKEY_ENABLE
 #   include "mousekey.h"
 #endif
@@ -44,25 +50,59 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #endif
 
 
-#ifdef MATRIX_HAS_GHOST
-static bool has_ghost_in_row(uint8_t row)
+/* Time of event in ms back-dated to when the row was sampled.
+ * This must be taken when the change is found, age in us wraps in 65ms. */
+static uint16_t sample_time(uint16_t sample_us)
+{
+    uint16_t age_us = (uint16_t)timer_read_us() - sample_us;
+    return (timer_read() - age_us/1000) | 1; /* time should not be 0 */
+}
+
+
+__attribute__ ((weak)) void matrix_setup(void) {}
+__attribute__ ((weak)) uint16_t matrix_get_row_time(uint8_t row) { return timer_read_us(); }
+__attribute__ ((weak)) matrix_rows_t matrix_changed_rows(void) { return ~(matrix_rows_t)0; }
+__attribute__ ((weak)) bool matrix_wake_arm(void) { return false; }
+__attribute__ ((weak)) bool matrix_woken(void) { return true; }
+__attribute__ ((weak)) void matrix_wake_disarm(void) {}
+__attribute__ ((weak)) bool suspend_idle_wakeup_condition(void) { return false; }
+
+#ifdef MATRIX_WAKE_ON_KEY
+#ifdef MATRIX_SCAN_ISR
+#   error "MATRIX_WAKE_ON_KEY can't be used with MATRIX_SCAN_ISR"
+#endif
+static bool any_key_on(const matrix_row_t m[])
 {
-    matrix_row_t matrix_row = matrix_get_row(row);
-    // No ghost exists when less than 2 keys are down on the row
-    if (((matrix_row - 1) & matrix_row) == 0)
-        return false;
-
-    // Ghost occurs when the row shares column line with other row
-    for (uint8_t i=0; i < MATRIX_ROWS; i++) {
-        if (i != row && (matrix_get_row(i) & matrix_row))
-            return true;
+    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+        if (m[r]) return true;
     }
     return false;
 }
+
+/* main loop has work other than key press */
+static bool idle_work(uint8_t led_status)
+{
+#if defined(PS2_MOUSE_ENABLE) || defined(SERIAL_MOUSE_ENABLE) || defined(ADB_MOUSE_ENABLE)
+    // mouse is polled
+    return true;
+#else
+    return suspend_idle_wakeup_condition() ||
+           led_status != host_keyboard_leds() ||
+           action_macro_playing() ||
+           keyboard_report_pending();
+#endif
+}
 #endif
 
+/* matrix state is read from buffer of ISR with MATRIX_SCAN_ISR */
+#ifdef MATRIX_SCAN_ISR
+#   define MATRIX_GET_ROW(row)      matrix_isr_get_row(row)
+#   define MATRIX_GET_ROW_TIME(row) matrix_isr_get_row_time(row)
+#else
+#   define MATRIX_GET_ROW(row)      matrix_get_row(row)
+#   define MATRIX_GET_ROW_TIME(row) matrix_get_row_time(row)
+#endif
 
-__attribute__ ((weak)) void matrix_setup(void) {}
 void keyboard_setup(void)
 {
     matrix_setup();
@@ -71,6 +111,8 @@ void keyboard_setup(void)
 void keyboard_init(void)
 {
     timer_init();
+    profile_clear();
+    trace_init();
     matrix_init();
 #ifdef PS2_MOUSE_ENABLE
     ps2_mouse_init();
@@ -90,29 +132,84 @@ void keyboard_init(void)
 #ifdef BACKLIGHT_ENABLE
     backlight_init();
 #endif
+
+#ifdef MATRIX_SCAN_ISR
+    matrix_isr_start();
+#endif
 }
 
 /*
  * Do keyboard routine jobs: scan mantrix, light LEDs, ...
  * This is repeatedly called as fast as possible.
+ *
+ * Without KEYBOARD_BATCH_EVENTS only one key event is processed per call.
+ * With KEYBOARD_BATCH_EVENTS all changes found in a scan are processed in
+ * row-major, column-ascending order and keyboard report is sent at most
+ * once at the end of the batch.
+ *
+ * With KEYBOARD_REPORT_COALESCE, which is implied by KEYBOARD_BATCH_EVENTS,
+ * keyboard reports made by actions in a call are merged into one.
+ *
+ * With MATRIX_WAKE_ON_KEY MCU sleeps at the end of call while no key is
+ * held. Other interrupts like timer tick and USB put it back to sleep
+ * without scan unless they leave work for main loop.
  */
 void keyboard_task(void)
 {
     static matrix_row_t matrix_prev[MATRIX_ROWS];
+    // rows whose change is not processed yet
+    static matrix_rows_t matrix_pending = 0;
+    // time of change on pending rows, kept while the row waits for process
+    static uint16_t matrix_pending_time[MATRIX_ROWS];
 #ifdef MATRIX_HAS_GHOST
     static matrix_row_t matrix_ghost[MATRIX_ROWS];
 #endif
     static uint8_t led_status = 0;
     matrix_row_t matrix_row = 0;
     matrix_row_t matrix_change = 0;
+#ifdef KEYBOARD_BATCH_EVENTS
+    uint8_t batch_count = 0;
+#endif
+    PROFILE_BEGIN(PROFILE_LOOP);
+
+#ifdef KEYBOARD_REPORT_COALESCE
+    hold_keyboard_report();
+#endif
 
+    PROFILE_BEGIN(PROFILE_MATRIX);
+#ifdef MATRIX_SCAN_ISR
+    matrix_rows_t matrix_changed = matrix_isr_fetch();
+#else
     matrix_scan();
-    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
-        matrix_row = matrix_get_row(r);
+    matrix_rows_t matrix_changed = matrix_changed_rows();
+#endif
+    PROFILE_END(PROFILE_MATRIX);
+
+    PROFILE_BEGIN(PROFILE_ACTION);
+    matrix_pending |= matrix_changed;
+    for (uint8_t r = 0; r < MATRIX_ROWS && matrix_changed; r++) {
+        if ((matrix_changed & ((matrix_rows_t)1<<r)) &&
+                MATRIX_GET_ROW(r) != matrix_prev[r]) {
+            matrix_pending_time[r] = sample_time(MATRIX_GET_ROW_TIME(r));
+        }
+    }
+#ifdef MATRIX_HAS_GHOST
+    // column occupancy must be up to date for all rows before ghost check
+    for (uint8_t r = 0; r < MATRIX_ROWS && matrix_changed; r++) {
+        if (matrix_changed & ((matrix_rows_t)1<<r)) {
+            matrix_ghost_update(r, MATRIX_GET_ROW(r));
+        }
+    }
+#endif
+    // rows without change are skipped, idle scan doesn't enter this loop.
+    for (uint8_t r = 0; r < MATRIX_ROWS && matrix_pending; r++) {
+        if (!(matrix_pending & ((matrix_rows_t)1<<r))) continue;
+
+        matrix_row = MATRIX_GET_ROW(r);
         matrix_change = matrix_row ^ matrix_prev[r];
         if (matrix_change) {
 #ifdef MATRIX_HAS_GHOST
-            if (has_ghost_in_row(r)) {
+            if (matrix_ghost_in_row(r)) {
                 /* Keep track of whether ghosted status has changed for
                  * debugging. But don't update matrix_prev until un-ghosted, or
                  * the last key would be lost.
@@ -126,31 +223,52 @@ void keyboard_task(void)
             matrix_ghost[r] = matrix_row;
 #endif
             if (debug_matrix) matrix_print();
+            uint16_t row_time = MATRIX_GET_ROW_TIME(r);
             for (uint8_t c = 0; c < MATRIX_COLS; c++) {
                 if (matrix_change & ((matrix_row_t)1<<c)) {
                     action_exec((keyevent_t){
                         .key = (keypos_t){ .row = r, .col = c },
                         .pressed = (matrix_row & ((matrix_row_t)1<<c)),
-                        .time = (timer_read() | 1) /* time should not be 0 */
+                        .time = matrix_pending_time[r],
+                        .time_us = row_time
                     });
                     // record a processed key
                     matrix_prev[r] ^= ((matrix_row_t)1<<c);
+#ifdef KEYBOARD_BATCH_EVENTS
+                    batch_count++;
+#else
                     // process a key per task call
                     goto MATRIX_LOOP_END;
+#endif
                 }
             }
         }
+        // all changes on the row are processed
+        matrix_pending &= ~((matrix_rows_t)1<<r);
     }
+#ifdef KEYBOARD_BATCH_EVENTS
+    if (batch_count) goto MATRIX_LOOP_END;
+#endif
     // call with pseudo tick event when no real key event.
     action_exec(TICK);
 
 MATRIX_LOOP_END:
+    action_macro_task();
+#ifdef KEYBOARD_REPORT_COALESCE
+    flush_keyboard_report();
+#endif
+    PROFILE_END(PROFILE_ACTION);
 
 #ifdef MOUSEKEY_ENABLE
     // mousekey repeat & acceleration
+    PROFILE_BEGIN(PROFILE_MOUSEKEY);
     mousekey_task();
+    PROFILE_END(PROFILE_MOUSEKEY);
 #endif
 
+#if defined(PS2_MOUSE_ENABLE) || defined(SERIAL_MOUSE_ENABLE) || defined(ADB_MOUSE_ENABLE)
+    PROFILE_BEGIN(PROFILE_MOUSE);
+#endif
 #ifdef PS2_MOUSE_ENABLE
     ps2_mouse_task();
 #endif
@@ -162,12 +280,25 @@ MATRIX_LOOP_END:
 #ifdef ADB_MOUSE_ENABLE
         adb_mouse_task();
 #endif
+#if defined(PS2_MOUSE_ENABLE) || defined(SERIAL_MOUSE_ENABLE) || defined(ADB_MOUSE_ENABLE)
+    PROFILE_END(PROFILE_MOUSE);
+#endif
 
     // update LED
     if (led_status != host_keyboard_leds()) {
         led_status = host_keyboard_leds();
         keyboard_set_leds(led_status);
     }
+    PROFILE_END(PROFILE_LOOP);
+
+#ifdef MATRIX_WAKE_ON_KEY
+    if (!matrix_pending && !any_key_on(matrix_prev) && matrix_wake_arm()) {
+        do {
+            suspend_idle(0);
+        } while (!matrix_woken() && !idle_work(led_status));
+        matrix_wake_disarm();
+    }
+#endif
 }
 
 void keyboard_set_leds(uint8_t leds)
@@ -36,7 +36,8 @@ typedef struct {
 typedef struct {
     keypos_t key;
     bool     pressed;
-    uint16_t time;
+    uint16_t time;      /* ms when the key was sampled */
+    uint16_t time_us;   /* lower 16bit of timer_read_us() when the key was sampled */
 } keyevent_t;
 
 /* equivalent test of keypos_t */
@@ -26,78 +26,84 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 static action_t keycode_to_action(uint8_t keycode);
 
 
+#ifdef BOOTMAGIC_ENABLE
+/*
+ * Keycode remap of keymap_config
+ *
+ * Keycodes swapped by keymap_config are in KC_ESCAPE...KC_CAPSLOCK,
+ * modifiers and KC_LOCKING_CAPS. Their translation is kept in a table
+ * which is rebuilt by keymap_remap_update() when keymap_config changes.
+ */
+#define REMAP_KEYS      (KC_CAPSLOCK - KC_ESCAPE + 1)
+#define REMAP_MODS      REMAP_KEYS
+#define REMAP_LCAP      (REMAP_MODS + 8)
+static uint8_t remap[REMAP_LCAP + 1];
+
+static uint8_t *remap_entry(uint8_t keycode)
+{
+    uint8_t i = keycode - KC_ESCAPE;
+    if (i < REMAP_KEYS) return &remap[i];
+    if (IS_MOD(keycode)) return &remap[REMAP_MODS + (keycode & 7)];
+    if (keycode == KC_LOCKING_CAPS) return &remap[REMAP_LCAP];
+    return 0;
+}
+#define REMAP(from, to) (*remap_entry(from) = (to))
+
+void keymap_remap_update(void)
+{
+    for (uint8_t i = 0; i < REMAP_KEYS; i++) remap[i] = KC_ESCAPE + i;
+    for (uint8_t i = 0; i < 8; i++) remap[REMAP_MODS + i] = KC_LCTRL + i;
+    remap[REMAP_LCAP] = KC_LOCKING_CAPS;
+
+    if (keymap_config.swap_control_capslock || keymap_config.capslock_to_control) {
+        REMAP(KC_CAPSLOCK, KC_LCTL);
+        REMAP(KC_LOCKING_CAPS, KC_LCTL);
+    }
+    if (keymap_config.swap_control_capslock) {
+        REMAP(KC_LCTL, KC_CAPSLOCK);
+    }
+    if (keymap_config.no_gui) {
+        REMAP(KC_LGUI, KC_NO);
+        REMAP(KC_RGUI, KC_NO);
+    }
+    if (keymap_config.swap_lalt_lgui) {
+        REMAP(KC_LALT, keymap_config.no_gui ? KC_NO : KC_LGUI);
+        REMAP(KC_LGUI, KC_LALT);
+    }
+    if (keymap_config.swap_ralt_rgui) {
+        REMAP(KC_RALT, keymap_config.no_gui ? KC_NO : KC_RGUI);
+        REMAP(KC_RGUI, KC_RALT);
+    }
+    if (keymap_config.swap_grave_esc) {
+        REMAP(KC_GRAVE, KC_ESC);
+        REMAP(KC_ESC, KC_GRAVE);
+    }
+    if (keymap_config.swap_backslash_backspace) {
+        REMAP(KC_BSLASH, KC_BSPACE);
+        REMAP(KC_BSPACE, KC_BSLASH);
+    }
+
+    layer_action_cache_clear();
+}
+
+static inline uint8_t keycode_remap(uint8_t keycode)
+{
+    uint8_t *entry = remap_entry(keycode);
+    return entry ? *entry : keycode;
+}
+#endif
+
+
 /* converts key to action */
 action_t action_for_key(uint8_t layer, keypos_t key)
 {
     uint8_t keycode = keymap_key_to_keycode(layer, key);
+#ifdef BOOTMAGIC_ENABLE
+    keycode = keycode_remap(keycode);
+#endif
     switch (keycode) {
         case KC_FN0 ... KC_FN31:
             return keymap_fn_to_action(keycode);
-#ifdef BOOTMAGIC_ENABLE
-        case KC_CAPSLOCK:
-        case KC_LOCKING_CAPS:
-            if (keymap_config.swap_control_capslock || keymap_config.capslock_to_control) {
-                return keycode_to_action(KC_LCTL);
-            }
-            return keycode_to_action(keycode);
-        case KC_LCTL:
-            if (keymap_config.swap_control_capslock) {
-                return keycode_to_action(KC_CAPSLOCK);
-            }
-            return keycode_to_action(KC_LCTL);
-        case KC_LALT:
-            if (keymap_config.swap_lalt_lgui) {
-                if (keymap_config.no_gui) {
-                    return keycode_to_action(ACTION_NO);
-                }
-                return keycode_to_action(KC_LGUI);
-            }
-            return keycode_to_action(KC_LALT);
-        case KC_LGUI:
-            if (keymap_config.swap_lalt_lgui) {
-                return keycode_to_action(KC_LALT);
-            }
-            if (keymap_config.no_gui) {
-                return keycode_to_action(ACTION_NO);
-            }
-            return keycode_to_action(KC_LGUI);
-        case KC_RALT:
-            if (keymap_config.swap_ralt_rgui) {
-                if (keymap_config.no_gui) {
-                    return keycode_to_action(ACTION_NO);
-                }
-                return keycode_to_action(KC_RGUI);
-            }
-            return keycode_to_action(KC_RALT);
-        case KC_RGUI:
-            if (keymap_config.swap_ralt_rgui) {
-                return keycode_to_action(KC_RALT);
-            }
-            if (keymap_config.no_gui) {
-                return keycode_to_action(ACTION_NO);
-            }
-            return keycode_to_action(KC_RGUI);
-        case KC_GRAVE:
-            if (keymap_config.swap_grave_esc) {
-                return keycode_to_action(KC_ESC);
-            }
-            return keycode_to_action(KC_GRAVE);
-        case KC_ESC:
-            if (keymap_config.swap_grave_esc) {
-                return keycode_to_action(KC_GRAVE);
-            }
-            return keycode_to_action(KC_ESC);
-        case KC_BSLASH:
-            if (keymap_config.swap_backslash_backspace) {
-                return keycode_to_action(KC_BSPACE);
-            }
-            return keycode_to_action(KC_BSLASH);
-        case KC_BSPACE:
-            if (keymap_config.swap_backslash_backspace) {
-                return keycode_to_action(KC_BSLASH);
-            }
-            return keycode_to_action(KC_BSPACE);
-#endif
         default:
             return keycode_to_action(keycode);
     }
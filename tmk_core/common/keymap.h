@@ -39,6 +39,9 @@ typedef union {
     };
 } keymap_config_t;
 keymap_config_t keymap_config;
+
+/* rebuild keycode remap table after keymap_config is changed */
+void keymap_remap_update(void);
 #endif
 
 
@@ -32,8 +32,22 @@ typedef  uint32_t   matrix_row_t;
 #error "MATRIX_COLS: invalid value"
 #endif
 
+/* bitmask of rows: bit n for row n */
+#if (MATRIX_ROWS <= 8)
+typedef  uint8_t    matrix_rows_t;
+#elif (MATRIX_ROWS <= 16)
+typedef  uint16_t   matrix_rows_t;
+#elif (MATRIX_ROWS <= 32)
+typedef  uint32_t   matrix_rows_t;
+#else
+#error "MATRIX_ROWS: invalid value"
+#endif
+
 #define MATRIX_IS_ON(row, col)  (matrix_get_row(row) && (1<<col))
 
+/* upper limit of row time age(us), drivers keep older time at this age as it wraps in 65ms */
+#define MATRIX_ROW_TIME_AGE_MAX 60000
+
 
 #ifdef __cplusplus
 extern "C" {
@@ -55,6 +69,10 @@ bool matrix_is_modified(void) __attribute__ ((deprecated));
 bool matrix_is_on(uint8_t row, uint8_t col);
 /* matrix state on row */
 matrix_row_t matrix_get_row(uint8_t row);
+/* time(lower 16bit of timer_read_us()) when the row state was sampled.(optional) */
+uint16_t matrix_get_row_time(uint8_t row);
+/* rows changed since last call. used after matrix_scan.(optional, default: all rows) */
+matrix_rows_t matrix_changed_rows(void);
 /* print matrix for debug */
 void matrix_print(void);
 
@@ -63,6 +81,13 @@ void matrix_print(void);
 void matrix_power_up(void);
 void matrix_power_down(void);
 
+/* wake on key: drive all lines and arm interrupt on key press, false if it can't sleep now.(optional) */
+bool matrix_wake_arm(void);
+/* key press is found while armed */
+bool matrix_woken(void);
+/* back to scanning after sleep */
+void matrix_wake_disarm(void);
+
 #ifdef __cplusplus
 }
 #endif
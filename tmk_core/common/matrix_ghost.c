@@ -0,0 +1,63 @@
+/*
+Copyright 2011 Jun Wako <wakojun@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "matrix.h"
+#include "matrix_ghost.h"
+
+
+#ifdef MATRIX_HAS_GHOST
+/*
+ * Column occupancy
+ *
+ * Number of active rows is counted on each column and columns which are
+ * shared by two or more rows are kept in a bitmap. Counts are updated
+ * incrementally with row changes so that ghost check of a row is
+ * constant time instead of scanning all other rows.
+ */
+static matrix_row_t ghost_rows[MATRIX_ROWS];
+static uint8_t col_rows[MATRIX_COLS];
+static matrix_row_t col_shared = 0;
+
+void matrix_ghost_update(uint8_t row, matrix_row_t state)
+{
+    matrix_row_t change = ghost_rows[row] ^ state;
+    if (!change) return;
+
+    ghost_rows[row] = state;
+    for (uint8_t c = 0; c < MATRIX_COLS && change; c++, change >>= 1) {
+        if (!(change & 1)) continue;
+
+        if (state & ((matrix_row_t)1<<c)) {
+            if (++col_rows[c] == 2) col_shared |= ((matrix_row_t)1<<c);
+        } else {
+            if (--col_rows[c] == 1) col_shared &= ~((matrix_row_t)1<<c);
+        }
+    }
+}
+
+bool matrix_ghost_in_row(uint8_t row)
+{
+    matrix_row_t matrix_row = ghost_rows[row];
+    // No ghost exists when less than 2 keys are down on the row
+    if (((matrix_row - 1) & matrix_row) == 0)
+        return false;
+
+    // Ghost occurs when the row shares column line with other row
+    return (matrix_row & col_shared);
+}
+#endif
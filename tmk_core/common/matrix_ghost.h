@@ -0,0 +1,41 @@
+/*
+Copyright 2011 Jun Wako <wakojun@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MATRIX_GHOST_H
+#define MATRIX_GHOST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "matrix.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef MATRIX_HAS_GHOST
+/* account state of row, only changed columns are updated */
+void matrix_ghost_update(uint8_t row, matrix_row_t state);
+/* whether the row has two or more keys and shares a column with other row */
+bool matrix_ghost_in_row(uint8_t row);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,50 @@
+/*
+Copyright 2015 Jun Wako <wakojun@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef MATRIX_ISR_H
+#define MATRIX_ISR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "matrix.h"
+
+
+/* scan rate(Hz) of MATRIX_SCAN_ISR */
+#ifndef MATRIX_SCAN_RATE
+#   define MATRIX_SCAN_RATE 1000
+#endif
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef MATRIX_SCAN_ISR
+/* start and stop scanning in timer interrupt */
+void matrix_isr_start(void);
+void matrix_isr_stop(void);
+/* take the latest scan result, returns rows changed since last fetch */
+matrix_rows_t matrix_isr_fetch(void);
+/* row state and its time from the fetched scan result */
+matrix_row_t matrix_isr_get_row(uint8_t row);
+uint16_t matrix_isr_get_row_time(uint8_t row);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
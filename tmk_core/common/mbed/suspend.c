@@ -1,5 +1,7 @@
 #include <stdbool.h>
+#include <stdint.h>
 
+void suspend_idle(uint8_t time) {}
 
 void suspend_power_down(void) {}
 bool suspend_wakeup_condition(void) { return true; }
@@ -39,3 +39,21 @@ uint32_t timer_elapsed32(uint32_t last)
 {
     return TIMER_DIFF_32(timer_read32(), last);
 }
+
+uint32_t timer_read_us(void)
+{
+    uint32_t t, val;
+
+    __disable_irq();
+    t = timer_count;
+    val = SysTick->VAL;
+    // SysTick wrapped but handler is not serviced yet
+    if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) {
+        val = SysTick->VAL;
+        t++;
+    }
+    __enable_irq();
+
+    // SysTick counts down from LOAD to 0 in 1ms
+    return t * 1000 + (SysTick->LOAD - val) * 1000 / (SysTick->LOAD + 1);
+}
@@ -0,0 +1,69 @@
+/*
+Copyright 2015 Jun Wako <wakojun@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <stdint.h>
+#include "timer_native.h"
+#include "timer.h"
+
+
+/* Mill second tick count */
+volatile uint32_t timer_count = 0;
+
+/* simulated time in us */
+static uint64_t timer_us = 0;
+
+
+void timer_advance_us(uint32_t us)
+{
+    timer_us += us;
+    timer_count = (uint32_t)(timer_us / 1000);
+}
+
+void timer_init(void)
+{
+    timer_clear();
+}
+
+void timer_clear(void)
+{
+    timer_us = 0;
+    timer_count = 0;
+}
+
+uint16_t timer_read(void)
+{
+    return (uint16_t)(timer_count & 0xFFFF);
+}
+
+uint32_t timer_read32(void)
+{
+    return timer_count;
+}
+
+uint16_t timer_elapsed(uint16_t last)
+{
+    return TIMER_DIFF_16(timer_read(), last);
+}
+
+uint32_t timer_elapsed32(uint32_t last)
+{
+    return TIMER_DIFF_32(timer_read32(), last);
+}
+
+uint32_t timer_read_us(void)
+{
+    return (uint32_t)timer_us;
+}
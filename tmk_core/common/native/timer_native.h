@@ -0,0 +1,39 @@
+/*
+Copyright 2015 Jun Wako <wakojun@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TIMER_NATIVE_H
+#define TIMER_NATIVE_H 1
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Simulated clock for native build
+ *
+ * Time doesn't pass by itself, it is advanced only with timer_advance_us()
+ * and wait_ms()/wait_us() so that runs are deterministic.
+ */
+void timer_advance_us(uint32_t us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,101 @@
+/*
+Copyright 2015 Jun Wako <wakojun@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <stdint.h>
+#include "timer.h"
+#include "print.h"
+#include "util.h"
+#include "progmem.h"
+#include "profile.h"
+
+
+static profile_stat_t profile_stats[PROFILE_STAGES];
+static uint32_t profile_since = 0;
+
+/* stage names in flash, fixed width to be read by pgm_read_byte() */
+static const char profile_names[PROFILE_STAGES][9] PROGMEM = {
+    [PROFILE_LOOP]      = "loop",
+    [PROFILE_MATRIX]    = "matrix",
+    [PROFILE_ACTION]    = "action",
+    [PROFILE_MOUSEKEY]  = "mousekey",
+    [PROFILE_MOUSE]     = "mouse",
+    [PROFILE_HOST_SEND] = "send",
+    [PROFILE_HOST_TASK] = "host",
+};
+
+
+void profile_record(uint8_t stage, uint16_t us)
+{
+    profile_stat_t *s = &profile_stats[stage];
+
+    if (s->count == 0 || us < s->min) s->min = us;
+    if (us > s->max) s->max = us;
+    s->total += us;
+    s->count++;
+
+    uint8_t bucket = 0;
+    if (us >= 32) {
+        bucket = biton16(us) - 4;
+        if (bucket >= PROFILE_HIST_SIZE) bucket = PROFILE_HIST_SIZE - 1;
+    }
+    if (s->hist[bucket] < UINT16_MAX) s->hist[bucket]++;
+}
+
+void profile_clear(void)
+{
+    for (uint8_t i = 0; i < PROFILE_STAGES; i++) {
+        profile_stats[i] = (profile_stat_t){};
+    }
+    profile_since = timer_read32();
+}
+
+static void print_stage_name(uint8_t stage)
+{
+    char c;
+    for (const char *p = profile_names[stage]; (c = pgm_read_byte(p)); p++) {
+        xprintf("%c", c);
+    }
+}
+
+/* count per second, count * 1000 overflows in long run */
+static uint32_t per_sec(uint32_t count, uint32_t ms)
+{
+    if (ms == 0) return 0;
+    if (ms >= 60000) return count / (ms / 1000);
+    return count * 1000 / ms;
+}
+
+void profile_print(void)
+{
+    uint32_t elapsed = timer_elapsed32(profile_since);
+
+    print("\n\t- Profile(us) -\n");
+    xprintf("elapsed: %lums  scan rate: %lu/s\n", elapsed,
+            per_sec(profile_stats[PROFILE_LOOP].count, elapsed));
+    print("stage\tcount\tmin\tmax\tmean\t<32 <64 <128 <256 <512 <1k <2k >=2k\n");
+    for (uint8_t i = 0; i < PROFILE_STAGES; i++) {
+        profile_stat_t *s = &profile_stats[i];
+        if (s->count == 0) continue;
+
+        print_stage_name(i);
+        xprintf("\t%lu\t%u\t%u\t%lu\t", s->count, s->min, s->max,
+                s->total / s->count);
+        for (uint8_t j = 0; j < PROFILE_HIST_SIZE; j++) {
+            xprintf("%u ", s->hist[j]);
+        }
+        print("\n");
+    }
+}
@@ -0,0 +1,71 @@
+/*
+Copyright 2015 Jun Wako <wakojun@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+#include "timer.h"
+
+
+/* stages of main loop to be measured */
+enum profile_stage {
+    PROFILE_LOOP,       /* whole keyboard_task */
+    PROFILE_MATRIX,     /* matrix_scan */
+    PROFILE_ACTION,     /* action_exec including report sends */
+    PROFILE_MOUSEKEY,   /* mousekey_task */
+    PROFILE_MOUSE,      /* PS/2, serial and ADB mouse tasks */
+    PROFILE_HOST_SEND,  /* host driver send functions */
+    PROFILE_HOST_TASK,  /* protocol task out of keyboard_task(e.g. USB host) */
+    PROFILE_STAGES
+};
+
+/* histogram bucket n counts durations less than (32<<n)us, last one counts the rest */
+#define PROFILE_HIST_SIZE   8
+
+typedef struct {
+    uint16_t min;
+    uint16_t max;
+    uint32_t total;
+    uint32_t count;
+    uint16_t hist[PROFILE_HIST_SIZE];
+} profile_stat_t;
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef PROFILE_ENABLE
+void profile_record(uint8_t stage, uint16_t us);
+void profile_clear(void);
+void profile_print(void);
+
+#define PROFILE_BEGIN(stage)    uint16_t profile_start_##stage = timer_read_us()
+#define PROFILE_END(stage)      profile_record(stage, (uint16_t)timer_read_us() - profile_start_##stage)
+#else
+#define profile_clear()
+#define profile_print()
+
+#define PROFILE_BEGIN(stage)
+#define PROFILE_END(stage)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
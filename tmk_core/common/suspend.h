@@ -9,5 +9,7 @@ void suspend_idle(uint8_t timeout);
 void suspend_power_down(void);
 bool suspend_wakeup_condition(void);
 void suspend_wakeup_init(void);
+/* protocol has work for main loop, ends sleep of MATRIX_WAKE_ON_KEY(optional) */
+bool suspend_idle_wakeup_condition(void);
 
 #endif
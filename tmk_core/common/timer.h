@@ -22,6 +22,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #if defined(__AVR__)
 #include "avr/timer_avr.h"
+#elif defined(PLATFORM_NATIVE)
+#include "native/timer_native.h"
 #endif
 
 
@@ -45,6 +47,8 @@ uint16_t timer_read(void);
 uint32_t timer_read32(void);
 uint16_t timer_elapsed(uint16_t last);
 uint32_t timer_elapsed32(uint32_t last);
+/* microsecond timestamp: resolution depends on hardware timer clock */
+uint32_t timer_read_us(void);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,112 @@
+/*
+Copyright 2015 Jun Wako <wakojun@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <stdint.h>
+#include "keyboard.h"
+#include "print.h"
+#include "trace.h"
+#ifdef TRACE_EEPROM
+#   include <avr/eeprom.h>
+#   include "eeconfig.h"
+#   if EECONFIG_TRACE_ADDR + 2 + 4 * TRACE_BUFFER_SIZE > E2END + 1
+#       error "TRACE_BUFFER_SIZE: trace doesn't fit in EEPROM"
+#   endif
+#endif
+
+
+/*
+ * Key event trace
+ *
+ * Key events are kept in a ring buffer of compact records so that the
+ * sequence and timing which led to a dropped or stuck key can be dumped
+ * over console or saved to EEPROM and then replayed on workstation with
+ * tool/native/tmk_replay.
+ */
+static trace_record_t trace_buffer[TRACE_BUFFER_SIZE];
+static uint8_t trace_head = 0;
+static uint8_t trace_len = 0;
+
+
+void trace_init(void)
+{
+#ifdef TRACE_EEPROM
+    // retain trace before reset
+    trace_load();
+#endif
+}
+
+void trace_clear(void)
+{
+    trace_head = 0;
+    trace_len = 0;
+}
+
+void trace_event(keyevent_t event)
+{
+    trace_buffer[trace_head] = (trace_record_t){
+        .row  = event.key.row,
+        .col  = (event.key.col & 0x7F) | (event.pressed ? 0x80 : 0),
+        .time = event.time
+    };
+    trace_head = (trace_head + 1) % TRACE_BUFFER_SIZE;
+    if (trace_len < TRACE_BUFFER_SIZE) trace_len++;
+}
+
+uint8_t trace_count(void)
+{
+    return trace_len;
+}
+
+keyevent_t trace_get(uint8_t n)
+{
+    trace_record_t *r = &trace_buffer[(trace_head + TRACE_BUFFER_SIZE - trace_len + n) % TRACE_BUFFER_SIZE];
+    return (keyevent_t){
+        .key = (keypos_t){ .row = r->row, .col = r->col & 0x7F },
+        .pressed = (r->col & 0x80),
+        .time = r->time
+    };
+}
+
+void trace_print(void)
+{
+    print("\n\t- Trace -\n");
+    for (uint8_t i = 0; i < trace_len; i++) {
+        keyevent_t e = trace_get(i);
+        xprintf("%04X%c(%u)\n", (e.key.row<<8 | e.key.col), (e.pressed ? 'd' : 'u'), e.time);
+    }
+}
+
+#ifdef TRACE_EEPROM
+/* EEPROM layout: length, head and records from EECONFIG_TRACE */
+void trace_save(void)
+{
+    eeprom_update_byte(EECONFIG_TRACE, trace_len);
+    eeprom_update_byte(EECONFIG_TRACE + 1, trace_head);
+    eeprom_update_block(trace_buffer, EECONFIG_TRACE + 2, sizeof(trace_buffer));
+}
+
+void trace_load(void)
+{
+    trace_len = eeprom_read_byte(EECONFIG_TRACE);
+    trace_head = eeprom_read_byte(EECONFIG_TRACE + 1);
+    if (trace_len > TRACE_BUFFER_SIZE || trace_head >= TRACE_BUFFER_SIZE) {
+        // erased or other layout
+        trace_clear();
+        return;
+    }
+    eeprom_read_block(trace_buffer, EECONFIG_TRACE + 2, sizeof(trace_buffer));
+}
+#endif
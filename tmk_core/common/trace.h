@@ -0,0 +1,67 @@
+/*
+Copyright 2015 Jun Wako <wakojun@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include "keyboard.h"
+
+
+/* number of key events retained in RAM */
+#ifndef TRACE_BUFFER_SIZE
+#define TRACE_BUFFER_SIZE   32
+#endif
+#if (TRACE_BUFFER_SIZE < 1 || TRACE_BUFFER_SIZE > 255)
+#error "TRACE_BUFFER_SIZE: invalid value"
+#endif
+
+/* compact record of key event: 4 bytes */
+typedef struct {
+    uint8_t  row;
+    uint8_t  col;       /* bit7: pressed */
+    uint16_t time;
+} trace_record_t;
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef TRACE_ENABLE
+void trace_init(void);
+void trace_clear(void);
+/* record key event, the oldest is overwritten when buffer is full */
+void trace_event(keyevent_t event);
+uint8_t trace_count(void);
+/* n-th oldest event */
+keyevent_t trace_get(uint8_t n);
+/* stream trace over console in the same format as debug_event() */
+void trace_print(void);
+#ifdef TRACE_EEPROM
+void trace_save(void);
+void trace_load(void);
+#endif
+#else
+#define trace_init()
+#define trace_event(event)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -9,6 +9,10 @@ extern "C" {
 #   include <util/delay.h>
 #   define wait_ms(ms)  _delay_ms(ms)
 #   define wait_us(us)  _delay_us(us)
+#elif defined(PLATFORM_NATIVE)
+#   include "native/timer_native.h"
+#   define wait_ms(ms)  timer_advance_us((uint32_t)(ms) * 1000)
+#   define wait_us(us)  timer_advance_us(us)
 #elif defined(__arm__)
 #   include "wait_api.h"
 #endif
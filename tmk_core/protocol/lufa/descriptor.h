@@ -158,6 +158,34 @@ typedef struct
 #define NKRO_EPSIZE                 16
 
 
+/* Polling interval(bInterval) of HID IN endpoints in ms */
+#ifndef KEYBOARD_POLLING_INTERVAL
+#   define KEYBOARD_POLLING_INTERVAL    10
+#endif
+#ifndef MOUSE_POLLING_INTERVAL
+#   define MOUSE_POLLING_INTERVAL       10
+#endif
+#ifndef EXTRAKEY_POLLING_INTERVAL
+#   define EXTRAKEY_POLLING_INTERVAL    10
+#endif
+#ifndef NKRO_POLLING_INTERVAL
+#   define NKRO_POLLING_INTERVAL        1
+#endif
+#if KEYBOARD_POLLING_INTERVAL < 1 || KEYBOARD_POLLING_INTERVAL > 255 || \
+    MOUSE_POLLING_INTERVAL < 1 || MOUSE_POLLING_INTERVAL > 255 || \
+    EXTRAKEY_POLLING_INTERVAL < 1 || EXTRAKEY_POLLING_INTERVAL > 255 || \
+    NKRO_POLLING_INTERVAL < 1 || NKRO_POLLING_INTERVAL > 255
+#   error "Polling interval must be in 1..255(ms)"
+#endif
+
+/* Bank of HID IN endpoints, double bank holds two reports in hardware */
+#ifdef LUFA_DOUBLE_BANK
+#   define HID_EPBANK               ENDPOINT_BANK_DOUBLE
+#else
+#   define HID_EPBANK               ENDPOINT_BANK_SINGLE
+#endif
+
+
 uint16_t CALLBACK_USB_GetDescriptor(const uint16_t wValue,
                                     const uint8_t wIndex,
                                     const void** const DescriptorAddress)
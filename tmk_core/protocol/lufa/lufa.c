@@ -136,6 +136,134 @@ static void Console_Task(void)
 #endif
 
 
+/*******************************************************************************
+ * Report queue
+ *
+ * Reports are written to the endpoint bank at once when it is free, otherwise
+ * they wait in a small per-endpoint queue and are sent from the SOF interrupt
+ * as the host polls the endpoint. The main loop spins on the endpoint only when
+ * a queue is full, up to about 10ms like sending without the queue, and the
+ * new report is dropped if the host doesn't take any in that time. Queued
+ * reports are never overwritten nor merged so that the host sees every press
+ * and release. Dropped reports, also those while not configured, are counted
+ * in report_overflow.
+ * System and consumer reports share the extrakey endpoint but are queued
+ * separately, so that one never overwrites the other's release.
+ ******************************************************************************/
+#ifdef LUFA_REPORT_QUEUE
+#ifndef LUFA_REPORT_QUEUE_SIZE
+#   define LUFA_REPORT_QUEUE_SIZE   4
+#endif
+#if LUFA_REPORT_QUEUE_SIZE < 1 || LUFA_REPORT_QUEUE_SIZE > 32
+#   error "LUFA_REPORT_QUEUE_SIZE must be in 1..32"
+#endif
+
+typedef struct {
+    uint8_t head;
+    uint8_t count;
+    uint8_t size;       // bytes per entry
+    uint8_t *buf;
+} report_queue_t;
+
+#define REPORT_QUEUE(name, type) \
+    static type name##_buf[LUFA_REPORT_QUEUE_SIZE]; \
+    static report_queue_t name = { 0, 0, sizeof(type), (uint8_t *)name##_buf }
+
+REPORT_QUEUE(keyboard_queue, report_keyboard_t);
+#ifdef MOUSE_ENABLE
+REPORT_QUEUE(mouse_queue, report_mouse_t);
+#endif
+#ifdef EXTRAKEY_ENABLE
+REPORT_QUEUE(system_queue, report_extra_t);
+REPORT_QUEUE(consumer_queue, report_extra_t);
+#endif
+
+static uint16_t report_overflow = 0;
+
+uint16_t lufa_report_overflows(void)
+{
+    return report_overflow;
+}
+
+static void report_queue_clear(void)
+{
+    keyboard_queue.count = 0;
+#ifdef MOUSE_ENABLE
+    mouse_queue.count = 0;
+#endif
+#ifdef EXTRAKEY_ENABLE
+    system_queue.count = 0;
+    consumer_queue.count = 0;
+#endif
+}
+
+/* queue must not be full */
+static void report_queue_push(report_queue_t *q, const void *report)
+{
+    uint8_t i = q->head + q->count++;
+    if (i >= LUFA_REPORT_QUEUE_SIZE) i -= LUFA_REPORT_QUEUE_SIZE;
+    memcpy(q->buf + i * q->size, report, q->size);
+}
+
+/* fill free banks of the endpoint; interrupts must be disabled */
+static void report_queue_flush(report_queue_t *q, uint8_t epnum, uint8_t len)
+{
+    Endpoint_SelectEndpoint(epnum);
+    while (q->count && Endpoint_IsReadWriteAllowed()) {
+        Endpoint_Write_Stream_LE(q->buf + q->head * q->size, len, NULL);
+        Endpoint_ClearIN();
+        if (++q->head == LUFA_REPORT_QUEUE_SIZE) q->head = 0;
+        q->count--;
+    }
+}
+
+static void report_queue_task(void)
+{
+    if (USB_DeviceState != DEVICE_STATE_Configured)
+        return;
+
+    uint8_t ep = Endpoint_GetCurrentEndpoint();
+#ifdef NKRO_ENABLE
+    if (keyboard_nkro)
+        report_queue_flush(&keyboard_queue, NKRO_IN_EPNUM, NKRO_EPSIZE);
+    else
+#endif
+        report_queue_flush(&keyboard_queue, KEYBOARD_IN_EPNUM, KEYBOARD_EPSIZE);
+#ifdef MOUSE_ENABLE
+    report_queue_flush(&mouse_queue, MOUSE_IN_EPNUM, sizeof(report_mouse_t));
+#endif
+#ifdef EXTRAKEY_ENABLE
+    report_queue_flush(&system_queue, EXTRAKEY_IN_EPNUM, sizeof(report_extra_t));
+    report_queue_flush(&consumer_queue, EXTRAKEY_IN_EPNUM, sizeof(report_extra_t));
+#endif
+    Endpoint_SelectEndpoint(ep);
+}
+
+/* returns false when report is dropped */
+static bool report_queue_send(report_queue_t *q, const void *report)
+{
+    uint8_t timeout = 255;
+    uint8_t sreg = SREG;
+    cli();
+    report_queue_task();
+    while (q->count == LUFA_REPORT_QUEUE_SIZE) {
+        SREG = sreg;
+        if (!--timeout) {
+            report_overflow++;
+            return false;
+        }
+        _delay_us(40);
+        cli();
+        report_queue_task();
+    }
+    report_queue_push(q, report);
+    report_queue_task();
+    SREG = sreg;
+    return true;
+}
+#endif
+
+
 /*******************************************************************************
  * USB Events
  ******************************************************************************/
@@ -202,10 +330,16 @@ static bool console_flush = false;
 #define CONSOLE_FLUSH_SET(b)   do { \
     uint8_t sreg = SREG; cli(); console_flush = b; SREG = sreg; \
 } while (0)
+#endif
 
+#if defined(CONSOLE_ENABLE) || defined(LUFA_REPORT_QUEUE)
 // called every 1ms
 void EVENT_USB_Device_StartOfFrame(void)
 {
+#ifdef LUFA_REPORT_QUEUE
+    report_queue_task();
+#endif
+#ifdef CONSOLE_ENABLE
     static uint8_t count;
     if (++count % 50) return;
     count = 0;
@@ -213,6 +347,7 @@ void EVENT_USB_Device_StartOfFrame(void)
     if (!console_flush) return;
     Console_Task();
     console_flush = false;
+#endif
 }
 #endif
 
@@ -223,20 +358,24 @@ void EVENT_USB_Device_ConfigurationChanged(void)
 {
     bool ConfigSuccess = true;
 
+#ifdef LUFA_REPORT_QUEUE
+    report_queue_clear();
+#endif
+
     /* Setup Keyboard HID Report Endpoints */
     ConfigSuccess &= ENDPOINT_CONFIG(KEYBOARD_IN_EPNUM, EP_TYPE_INTERRUPT, ENDPOINT_DIR_IN,
-                                     KEYBOARD_EPSIZE, ENDPOINT_BANK_SINGLE);
+                                     KEYBOARD_EPSIZE, HID_EPBANK);
 
 #ifdef MOUSE_ENABLE
     /* Setup Mouse HID Report Endpoint */
     ConfigSuccess &= ENDPOINT_CONFIG(MOUSE_IN_EPNUM, EP_TYPE_INTERRUPT, ENDPOINT_DIR_IN,
-                                     MOUSE_EPSIZE, ENDPOINT_BANK_SINGLE);
+                                     MOUSE_EPSIZE, HID_EPBANK);
 #endif
 
 #ifdef EXTRAKEY_ENABLE
     /* Setup Extra HID Report Endpoint */
     ConfigSuccess &= ENDPOINT_CONFIG(EXTRAKEY_IN_EPNUM, EP_TYPE_INTERRUPT, ENDPOINT_DIR_IN,
-                                     EXTRAKEY_EPSIZE, ENDPOINT_BANK_SINGLE);
+                                     EXTRAKEY_EPSIZE, HID_EPBANK);
 #endif
 
 #ifdef CONSOLE_ENABLE
@@ -252,7 +391,7 @@ void EVENT_USB_Device_ConfigurationChanged(void)
 #ifdef NKRO_ENABLE
     /* Setup NKRO HID Report Endpoints */
     ConfigSuccess &= ENDPOINT_CONFIG(NKRO_IN_EPNUM, EP_TYPE_INTERRUPT, ENDPOINT_DIR_IN,
-                                     NKRO_EPSIZE, ENDPOINT_BANK_SINGLE);
+                                     NKRO_EPSIZE, HID_EPBANK);
 #endif
 }
 
@@ -388,6 +527,62 @@ static uint8_t keyboard_leds(void)
     return keyboard_led_stats;
 }
 
+#ifdef LUFA_REPORT_QUEUE
+static void send_keyboard(report_keyboard_t *report)
+{
+    if (USB_DeviceState != DEVICE_STATE_Configured) {
+        report_overflow++;
+        return;
+    }
+
+    if (report_queue_send(&keyboard_queue, report))
+        keyboard_report_sent = *report;
+}
+
+static void send_mouse(report_mouse_t *report)
+{
+#ifdef MOUSE_ENABLE
+    if (USB_DeviceState != DEVICE_STATE_Configured) {
+        report_overflow++;
+        return;
+    }
+
+    report_queue_send(&mouse_queue, report);
+#endif
+}
+
+static void send_system(uint16_t data)
+{
+#ifdef EXTRAKEY_ENABLE
+    if (USB_DeviceState != DEVICE_STATE_Configured) {
+        report_overflow++;
+        return;
+    }
+
+    report_extra_t r = {
+        .report_id = REPORT_ID_SYSTEM,
+        .usage = data
+    };
+    report_queue_send(&system_queue, &r);
+#endif
+}
+
+static void send_consumer(uint16_t data)
+{
+#ifdef EXTRAKEY_ENABLE
+    if (USB_DeviceState != DEVICE_STATE_Configured) {
+        report_overflow++;
+        return;
+    }
+
+    report_extra_t r = {
+        .report_id = REPORT_ID_CONSUMER,
+        .usage = data
+    };
+    report_queue_send(&consumer_queue, &r);
+#endif
+}
+#else
 static void send_keyboard(report_keyboard_t *report)
 {
     uint8_t timeout = 255;
@@ -401,8 +596,8 @@ static void send_keyboard(report_keyboard_t *report)
         /* Report protocol - NKRO */
         Endpoint_SelectEndpoint(NKRO_IN_EPNUM);
 
-        /* Check if write ready for a polling interval around 1ms */
-        while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(4);
+        /* Check if write ready for a polling interval of the endpoint */
+        while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(NKRO_POLLING_INTERVAL * 4);
         if (!Endpoint_IsReadWriteAllowed()) return;
 
         /* Write Keyboard Report Data */
@@ -414,8 +609,8 @@ static void send_keyboard(report_keyboard_t *report)
         /* Boot protocol */
         Endpoint_SelectEndpoint(KEYBOARD_IN_EPNUM);
 
-        /* Check if write ready for a polling interval around 10ms */
-        while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(40);
+        /* Check if write ready for a polling interval of the endpoint */
+        while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(KEYBOARD_POLLING_INTERVAL * 4);
         if (!Endpoint_IsReadWriteAllowed()) return;
 
         /* Write Keyboard Report Data */
@@ -439,8 +634,8 @@ static void send_mouse(report_mouse_t *report)
     /* Select the Mouse Report Endpoint */
     Endpoint_SelectEndpoint(MOUSE_IN_EPNUM);
 
-    /* Check if write ready for a polling interval around 10ms */
-    while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(40);
+    /* Check if write ready for a polling interval of the endpoint */
+    while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(MOUSE_POLLING_INTERVAL * 4);
     if (!Endpoint_IsReadWriteAllowed()) return;
 
     /* Write Mouse Report Data */
@@ -464,8 +659,8 @@ static void send_system(uint16_t data)
     };
     Endpoint_SelectEndpoint(EXTRAKEY_IN_EPNUM);
 
-    /* Check if write ready for a polling interval around 10ms */
-    while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(40);
+    /* Check if write ready for a polling interval of the endpoint */
+    while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(EXTRAKEY_POLLING_INTERVAL * 4);
     if (!Endpoint_IsReadWriteAllowed()) return;
 
     Endpoint_Write_Stream_LE(&r, sizeof(report_extra_t), NULL);
@@ -485,13 +680,33 @@ static void send_consumer(uint16_t data)
     };
     Endpoint_SelectEndpoint(EXTRAKEY_IN_EPNUM);
 
-    /* Check if write ready for a polling interval around 10ms */
-    while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(40);
+    /* Check if write ready for a polling interval of the endpoint */
+    while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(EXTRAKEY_POLLING_INTERVAL * 4);
     if (!Endpoint_IsReadWriteAllowed()) return;
 
     Endpoint_Write_Stream_LE(&r, sizeof(report_extra_t), NULL);
     Endpoint_ClearIN();
 }
+#endif
+
+
+#ifdef MATRIX_WAKE_ON_KEY
+/* control request and state change are processed in main loop */
+bool suspend_idle_wakeup_condition(void)
+{
+    if (USB_DeviceState != DEVICE_STATE_Configured)
+        return true;
+#if defined(INTERRUPT_CONTROL_ENDPOINT)
+    return false;
+#else
+    uint8_t ep = Endpoint_GetCurrentEndpoint();
+    Endpoint_SelectEndpoint(ENDPOINT_CONTROLEP);
+    bool setup = Endpoint_IsSETUPReceived();
+    Endpoint_SelectEndpoint(ep);
+    return setup;
+#endif
+}
+#endif
 
 
 /*******************************************************************************
@@ -56,6 +56,11 @@ extern "C" {
 
 extern host_driver_t lufa_driver;
 
+#ifdef LUFA_REPORT_QUEUE
+/* number of report transitions lost to a full queue */
+uint16_t lufa_report_overflows(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -41,6 +41,14 @@
 #define CPU_PRESCALE(n)    (CLKPR = 0x80, CLKPR = (n))
 
 
+#ifdef MATRIX_WAKE_ON_KEY
+/* USB is handled in interrupt, main loop only has to see suspend */
+bool suspend_idle_wakeup_condition(void)
+{
+    return suspend;
+}
+#endif
+
 int main(void)
 {
     // set for 16 MHz clock
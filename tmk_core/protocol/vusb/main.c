@@ -18,6 +18,7 @@
 #include "keyboard.h"
 #include "host.h"
 #include "timer.h"
+#include "suspend.h"
 #include "uart.h"
 #include "debug.h"
 
@@ -41,6 +42,14 @@ static void initForUsbConnectivity(void)
     sei();
 }
 
+#ifdef MATRIX_WAKE_ON_KEY
+/* usbPoll() builds control replies in main loop, run it on every wakeup */
+bool suspend_idle_wakeup_condition(void)
+{
+    return true;
+}
+#endif
+
 int main(void)
 {
     bool suspended = false;
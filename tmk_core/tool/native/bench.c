@@ -0,0 +1,279 @@
+/*
+Copyright 2015 Jun Wako <wakojun@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "keyboard.h"
+#include "keymap.h"
+#include "host.h"
+#include "timer.h"
+#include "action_layer.h"
+#include "action_util.h"
+#include "bench.h"
+
+
+/*
+ * Benchmark runner
+ *
+ * Synthetic key events are put on simulated matrix and keyboard_task() is
+ * run until the host driver receives reports reflecting them. Throughput is
+ * measured with wall clock and report latency with simulated clock which
+ * advances BENCH_SCAN_PERIOD per keyboard_task() call.
+ */
+
+/* give up waiting for report after this many keyboard_task() calls */
+#define MAX_TASKS       2000
+#define MAX_PENDING     16
+/* calls long enough to settle tapping state */
+#define SETTLE_TASKS    (300000 / BENCH_SCAN_PERIOD)
+
+/* key change waiting for its report */
+typedef struct {
+    uint8_t  code[2];       /* keycode on layer 0 and 1 */
+    bool     pressed;
+    uint32_t time_us;
+} pending_t;
+
+static pending_t pending[MAX_PENDING];
+static uint8_t pending_count = 0;
+static uint32_t report_checked = 0;
+
+static uint64_t events;
+static uint64_t latency_total;
+static uint32_t latency_max;
+static uint32_t latency_count;
+static uint32_t timeouts;
+
+static uint32_t rand_state = 1;
+
+
+static uint32_t rand_next(void)
+{
+    rand_state ^= rand_state << 13;
+    rand_state ^= rand_state >> 17;
+    rand_state ^= rand_state << 5;
+    return rand_state;
+}
+
+static double wall_time(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static bool report_has_key(report_keyboard_t *report, uint8_t code)
+{
+    if (IS_MOD(code)) return report->mods & MOD_BIT(code);
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        if (report->keys[i] == code) return true;
+    }
+    return false;
+}
+
+/* resolve pending key changes with reports sent since last check */
+static void check_reports(void)
+{
+    for (; report_checked < host_log_count(); report_checked++) {
+        host_log_t *log = host_log_get(report_checked);
+        for (uint8_t i = 0; i < pending_count; ) {
+            pending_t *p = &pending[i];
+            bool on = report_has_key(&log->report, p->code[0]) ||
+                      (p->code[1] && report_has_key(&log->report, p->code[1]));
+            if (on == p->pressed) {
+                uint32_t latency = log->time_us - p->time_us;
+                latency_total += latency;
+                latency_count++;
+                if (latency > latency_max) latency_max = latency;
+                pending[i] = pending[--pending_count];
+            } else {
+                i++;
+            }
+        }
+    }
+}
+
+static void key_change(uint8_t row, uint8_t col, bool pressed)
+{
+    keypos_t key = { .row = row, .col = col };
+    uint8_t code1 = keymap_key_to_keycode(1, key);
+
+    matrix_sim_set(row, col, pressed);
+    events++;
+    if (pending_count < MAX_PENDING) {
+        pending[pending_count++] = (pending_t){
+            .code = { keymap_key_to_keycode(0, key), (code1 == KC_TRNS ? KC_NO : code1) },
+            .pressed = pressed,
+            .time_us = timer_read_us()
+        };
+    }
+}
+
+static void task(void)
+{
+    keyboard_task();
+    timer_advance_us(BENCH_SCAN_PERIOD);
+    check_reports();
+}
+
+static void run_until_reported(void)
+{
+    for (uint16_t n = 0; pending_count && n < MAX_TASKS; n++) {
+        task();
+    }
+    if (pending_count) {
+        timeouts += pending_count;
+        pending_count = 0;
+    }
+}
+
+static void run_idle(uint16_t n)
+{
+    while (n--) task();
+}
+
+/* plain key on row 0-6 */
+static void random_key(uint8_t *row, uint8_t *col)
+{
+    uint32_t r = rand_next() % (7 * MATRIX_COLS);
+    *row = r / MATRIX_COLS;
+    *col = r % MATRIX_COLS;
+}
+
+
+/* press and release one key at a time */
+static void scenario_type(void)
+{
+    uint8_t row, col;
+    random_key(&row, &col);
+    key_change(row, col, true);
+    run_until_reported();
+    key_change(row, col, false);
+    run_until_reported();
+}
+
+/* press next key before releasing previous one */
+static void scenario_roll(void)
+{
+    uint8_t row[4], col[4];
+    for (uint8_t i = 0; i < 4; i++) {
+        random_key(&row[i], &col[i]);
+        for (uint8_t j = 0; j < i; j++) {
+            if (row[i] == row[j] && col[i] == col[j]) { i--; break; }
+        }
+    }
+    for (uint8_t i = 0; i < 4; i++) {
+        key_change(row[i], col[i], true);
+        task();
+        if (i) {
+            key_change(row[i-1], col[i-1], false);
+            task();
+        }
+    }
+    key_change(row[3], col[3], false);
+    run_until_reported();
+}
+
+/* press and release several keys in the same scan */
+static void scenario_chord(void)
+{
+    uint8_t row = rand_next() % 7;
+    uint8_t cols = (rand_next() & 0x3F) | 0x03;
+    for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+        if (cols & (1<<c)) key_change(row, c, true);
+    }
+    run_until_reported();
+    for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+        if (cols & (1<<c)) key_change(row, c, false);
+    }
+    run_until_reported();
+}
+
+/* type a plain key while holding a dual-role key */
+static void scenario_dual_role(void)
+{
+    uint8_t row, col;
+    uint8_t fn = rand_next() % 2;
+    random_key(&row, &col);
+
+    matrix_sim_set(7, fn, true);
+    events++;
+    task();
+    key_change(row, col, true);
+    task();
+    key_change(row, col, false);
+    task();
+    matrix_sim_set(7, fn, false);
+    events++;
+    run_until_reported();
+    run_idle(SETTLE_TASKS);
+}
+
+
+static void bench_reset(void)
+{
+    matrix_sim_clear();
+    run_idle(SETTLE_TASKS);
+    clear_keyboard();
+    layer_clear();
+    pending_count = 0;
+    report_checked = host_log_count();
+    events = 0;
+    latency_total = 0;
+    latency_max = 0;
+    latency_count = 0;
+    timeouts = 0;
+}
+
+static void bench(const char *name, void (*scenario)(void), uint64_t n)
+{
+    bench_reset();
+    uint32_t reports = host_log_count();
+    double start = wall_time();
+    while (events < n) {
+        scenario();
+    }
+    double elapsed = wall_time() - start;
+    reports = host_log_count() - reports;
+
+    printf("%-10s %10llu %12.0f %10lu %10.1f %10lu %8lu\n", name,
+           (unsigned long long)events, events / elapsed, (unsigned long)reports,
+           latency_count ? (double)latency_total / latency_count : 0.0,
+           (unsigned long)latency_max, (unsigned long)timeouts);
+}
+
+
+int main(int argc, char **argv)
+{
+    uint64_t n = 1000000;
+    if (argc > 1) n = strtoull(argv[1], NULL, 0);
+
+    host_set_driver(&recording_driver);
+    keyboard_init();
+
+    printf("scan period: %uus\n", BENCH_SCAN_PERIOD);
+    printf("%-10s %10s %12s %10s %10s %10s %8s\n",
+           "scenario", "events", "events/s", "reports", "lat(us)", "max(us)", "lost");
+    bench("type", scenario_type, n);
+    bench("roll", scenario_roll, n);
+    bench("chord", scenario_chord, n);
+    bench("dual-role", scenario_dual_role, n / 10);
+    return 0;
+}
@@ -0,0 +1,48 @@
+/*
+Copyright 2015 Jun Wako <wakojun@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "report.h"
+#include "host_driver.h"
+
+
+/* Simulated matrix: state is set by benchmark script instead of scanning */
+void matrix_sim_set(uint8_t row, uint8_t col, bool on);
+void matrix_sim_clear(void);
+
+
+/* Recording host driver: keyboard reports are logged with simulated time */
+#define HOST_LOG_SIZE   64
+
+typedef struct {
+    uint32_t time_us;
+    report_keyboard_t report;
+} host_log_t;
+
+extern host_driver_t recording_driver;
+
+/* number of keyboard reports sent so far */
+uint32_t host_log_count(void);
+/* n-th keyboard report, only last HOST_LOG_SIZE reports are retained */
+host_log_t *host_log_get(uint32_t n);
+void host_log_clear(void);
+
+#endif
@@ -0,0 +1,79 @@
+/*
+Copyright 2015 Jun Wako <wakojun@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <stdint.h>
+#include "report.h"
+#include "host_driver.h"
+#include "timer.h"
+#include "bench.h"
+
+
+static host_log_t host_log[HOST_LOG_SIZE];
+static uint32_t host_log_n = 0;
+
+static uint8_t keyboard_leds(void);
+static void send_keyboard(report_keyboard_t *report);
+static void send_mouse(report_mouse_t *report);
+static void send_system(uint16_t data);
+static void send_consumer(uint16_t data);
+
+host_driver_t recording_driver = {
+    keyboard_leds,
+    send_keyboard,
+    send_mouse,
+    send_system,
+    send_consumer
+};
+
+
+uint32_t host_log_count(void)
+{
+    return host_log_n;
+}
+
+host_log_t *host_log_get(uint32_t n)
+{
+    return &host_log[n % HOST_LOG_SIZE];
+}
+
+void host_log_clear(void)
+{
+    host_log_n = 0;
+}
+
+static uint8_t keyboard_leds(void)
+{
+    return 0;
+}
+
+static void send_keyboard(report_keyboard_t *report)
+{
+    host_log_t *log = &host_log[host_log_n++ % HOST_LOG_SIZE];
+    log->time_us = timer_read_us();
+    log->report = *report;
+}
+
+static void send_mouse(report_mouse_t *report)
+{
+}
+
+static void send_system(uint16_t data)
+{
+}
+
+static void send_consumer(uint16_t data)
+{
+}
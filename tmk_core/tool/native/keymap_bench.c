@@ -0,0 +1,76 @@
+/*
+Copyright 2015 Jun Wako <wakojun@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <stdint.h>
+#include "keycode.h"
+#include "action.h"
+#include "action_code.h"
+#include "keymap.h"
+
+
+/* plain keys on row 0-6, dual-role and modifier keys on row 7 */
+static const uint8_t keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
+    {
+        { KC_A,    KC_B,    KC_C,    KC_D,    KC_E,    KC_F,    KC_G,    KC_H    },
+        { KC_I,    KC_J,    KC_K,    KC_L,    KC_M,    KC_N,    KC_O,    KC_P    },
+        { KC_Q,    KC_R,    KC_S,    KC_T,    KC_U,    KC_V,    KC_W,    KC_X    },
+        { KC_Y,    KC_Z,    KC_1,    KC_2,    KC_3,    KC_4,    KC_5,    KC_6    },
+        { KC_7,    KC_8,    KC_9,    KC_0,    KC_MINS, KC_EQL,  KC_LBRC, KC_RBRC },
+        { KC_BSLS, KC_SCLN, KC_QUOT, KC_GRV,  KC_COMM, KC_DOT,  KC_SLSH, KC_TAB  },
+        { KC_F1,   KC_F2,   KC_F3,   KC_F4,   KC_F5,   KC_F6,   KC_F7,   KC_F8   },
+        { KC_FN0,  KC_FN1,  KC_LSFT, KC_LCTL, KC_LALT, KC_RSFT, KC_RCTL, KC_RALT },
+    },
+    {
+        { KC_F9,   KC_F10,  KC_F11,  KC_F12,  KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS },
+        { KC_LEFT, KC_DOWN, KC_UP,   KC_RGHT, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS },
+        { KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS },
+        { KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS },
+        { KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS },
+        { KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS },
+        { KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS },
+        { KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS, KC_TRNS },
+    },
+};
+
+static const uint16_t fn_actions[] = {
+    [0] = ACTION_LAYER_TAP_KEY(1, KC_SPC),
+    [1] = ACTION_MODS_TAP_KEY(MOD_LSFT, KC_ENT),
+};
+
+#define KEYMAPS_SIZE    (sizeof(keymaps) / sizeof(keymaps[0]))
+#define FN_ACTIONS_SIZE (sizeof(fn_actions) / sizeof(fn_actions[0]))
+
+
+uint8_t keymap_key_to_keycode(uint8_t layer, keypos_t key)
+{
+    if (layer >= KEYMAPS_SIZE) layer = 0;
+    return keymaps[layer][key.row][key.col];
+}
+
+action_t keymap_fn_to_action(uint8_t keycode)
+{
+    action_t action;
+    if (FN_INDEX(keycode) < FN_ACTIONS_SIZE) {
+        action.code = fn_actions[FN_INDEX(keycode)];
+    } else {
+        action.code = ACTION_NO;
+    }
+    return action;
+}
+
+void led_set(uint8_t usb_led)
+{
+}
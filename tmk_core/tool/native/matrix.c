@@ -0,0 +1,82 @@
+/*
+Copyright 2015 Jun Wako <wakojun@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "matrix.h"
+#include "bench.h"
+
+
+static matrix_row_t matrix[MATRIX_ROWS];
+static matrix_rows_t matrix_changed = 0;
+
+
+void matrix_sim_set(uint8_t row, uint8_t col, bool on)
+{
+    if (on) {
+        matrix[row] |=  ((matrix_row_t)1<<col);
+    } else {
+        matrix[row] &= ~((matrix_row_t)1<<col);
+    }
+    matrix_changed |= ((matrix_rows_t)1<<row);
+}
+
+void matrix_sim_clear(void)
+{
+    for (uint8_t i = 0; i < MATRIX_ROWS; i++) matrix[i] = 0;
+    matrix_changed = ~(matrix_rows_t)0;
+}
+
+uint8_t matrix_rows(void)
+{
+    return MATRIX_ROWS;
+}
+
+uint8_t matrix_cols(void)
+{
+    return MATRIX_COLS;
+}
+
+void matrix_init(void)
+{
+    matrix_sim_clear();
+}
+
+uint8_t matrix_scan(void)
+{
+    return 1;
+}
+
+bool matrix_is_on(uint8_t row, uint8_t col)
+{
+    return (matrix[row] & ((matrix_row_t)1<<col));
+}
+
+matrix_row_t matrix_get_row(uint8_t row)
+{
+    return matrix[row];
+}
+
+matrix_rows_t matrix_changed_rows(void)
+{
+    matrix_rows_t changed = matrix_changed;
+    matrix_changed = 0;
+    return changed;
+}
+
+void matrix_print(void)
+{
+}
@@ -0,0 +1,125 @@
+/*
+Copyright 2015 Jun Wako <wakojun@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "keyboard.h"
+#include "action.h"
+#include "host.h"
+#include "timer.h"
+#include "report.h"
+#include "bench.h"
+
+
+/*
+ * Trace replay
+ *
+ * Key event trace dumped by trace_print() is fed into action_exec() with its
+ * original intervals and keyboard reports sent to host are printed, one per
+ * line with time(ms) from the first event:
+ *
+ *     12: 02 | 04 00 00 00 00 00
+ *
+ * Lines without event like '0102d(4660)' are ignored, so console log can be
+ * given as is. Outputs of the replay can be kept as regression corpus.
+ */
+
+/* calls long enough to settle tapping state after the last event */
+#define SETTLE_TASKS    (300000 / BENCH_SCAN_PERIOD)
+
+static uint32_t start_us;
+static uint32_t report_printed = 0;
+
+
+static bool parse_event(const char *line, keyevent_t *event)
+{
+    unsigned int pos, time;
+    char c;
+    for (; *line; line++) {
+        if (sscanf(line, "%4x%c(%u)", &pos, &c, &time) == 3 && (c == 'd' || c == 'u')) {
+            *event = (keyevent_t){
+                .key = (keypos_t){ .row = pos>>8, .col = pos & 0xFF },
+                .pressed = (c == 'd'),
+                .time = time
+            };
+            return true;
+        }
+    }
+    return false;
+}
+
+static void print_reports(void)
+{
+    for (; report_printed < host_log_count(); report_printed++) {
+        host_log_t *log = host_log_get(report_printed);
+        printf("%u: %02X |", (log->time_us - start_us) / 1000, log->report.mods);
+        for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+            printf(" %02X", log->report.keys[i]);
+        }
+        printf("\n");
+    }
+}
+
+/* run action_exec() with TICK like keyboard_task() for the period */
+static void idle(uint32_t ms)
+{
+    uint32_t us = (uint32_t)ms * 1000;
+    while (us >= BENCH_SCAN_PERIOD) {
+        timer_advance_us(BENCH_SCAN_PERIOD);
+        us -= BENCH_SCAN_PERIOD;
+        action_exec(TICK);
+        print_reports();
+    }
+    timer_advance_us(us);
+}
+
+int main(int argc, char **argv)
+{
+    FILE *in = stdin;
+    if (argc > 1 && !(in = fopen(argv[1], "r"))) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    timer_init();
+    host_set_driver(&recording_driver);
+    start_us = timer_read_us();
+
+    char line[128];
+    bool first = true;
+    uint16_t last_time = 0;
+    keyevent_t event;
+    while (fgets(line, sizeof(line), in)) {
+        if (!parse_event(line, &event)) continue;
+
+        if (!first) {
+            // 16bit time stamp wraps around in 65s
+            idle((uint16_t)(event.time - last_time));
+        }
+        first = false;
+        last_time = event.time;
+
+        // rebase time stamp on simulated clock
+        event.time = (timer_read() | 1);
+        action_exec(event);
+        print_reports();
+    }
+    idle(SETTLE_TASKS * BENCH_SCAN_PERIOD / 1000);
+
+    if (in != stdin) fclose(in);
+    return 0;
+}
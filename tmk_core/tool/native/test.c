@@ -0,0 +1,108 @@
+/*
+Copyright 2015 Jun Wako <wakojun@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "keyboard.h"
+#include "keycode.h"
+#include "host.h"
+#include "action.h"
+#include "action_util.h"
+#include "bench.h"
+
+
+/*
+ * Report tests
+ *
+ * Reports sent to recording host driver are checked for presses and
+ * releases which host should see. Exit status is number of failures.
+ */
+
+#ifdef KEYBOARD_REPORT_COALESCE
+static uint8_t failures = 0;
+
+
+static bool report_has_code(report_keyboard_t *report, uint8_t code)
+{
+    if (IS_MOD(code)) return report->mods & MOD_BIT(code);
+#ifdef NKRO_ENABLE
+    if (keyboard_nkro) return report->nkro.bits[code>>3] & (1<<(code&7));
+#endif
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        if (report->keys[i] == code) return true;
+    }
+    return false;
+}
+
+/* presses of code in reports logged since n-th, state before them is off */
+static uint8_t count_presses(uint32_t n, uint8_t code, bool *on)
+{
+    uint8_t presses = 0;
+    *on = false;
+    for (; n < host_log_count(); n++) {
+        bool cur = report_has_code(&host_log_get(n)->report, code);
+        if (cur && !*on) presses++;
+        *on = cur;
+    }
+    return presses;
+}
+
+static void check(const char *name, uint32_t start, uint8_t code, uint8_t presses)
+{
+    bool on;
+    uint8_t n = count_presses(start, code, &on);
+    bool ok = (n == presses && !on);
+    printf("%-30s %s (presses: %u, last: %s)\n", name, ok ? "ok" : "FAIL", n, on ? "on" : "off");
+    if (!ok) failures++;
+}
+
+/* press/release/press/release of one key in a hold must reach host as two taps */
+static void test_retap_in_hold(const char *name, uint8_t code)
+{
+    clear_keyboard();
+    uint32_t start = host_log_count();
+    hold_keyboard_report();
+    register_code(code);
+    unregister_code(code);
+    register_code(code);
+    unregister_code(code);
+    flush_keyboard_report();
+    check(name, start, code, 2);
+}
+#endif
+
+
+int main(void)
+{
+    host_set_driver(&recording_driver);
+    keyboard_init();
+
+#ifdef KEYBOARD_REPORT_COALESCE
+    test_retap_in_hold("retap key in hold", KC_A);
+    test_retap_in_hold("retap mod in hold", KC_LSHIFT);
+#ifdef NKRO_ENABLE
+    keyboard_nkro = true;
+    test_retap_in_hold("retap key in hold(NKRO)", KC_A);
+    test_retap_in_hold("retap mod in hold(NKRO)", KC_LSHIFT);
+    keyboard_nkro = false;
+#endif
+    return failures;
+#else
+    printf("skip: KEYBOARD_REPORT_COALESCE is not defined\n");
+    return 0;
+#endif
+}